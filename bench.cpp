@@ -0,0 +1,375 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+#include <omp.h>
+#include "genetic.h"
+#include "bot.h"
+
+using namespace std;
+
+#define SIZE_OF_CORPUS 1000     // # of fields of corpus.
+#define NUM_OF_BENCH_GAME 20    // # of games played to measure moves per second.
+
+/*
+ Result of each benchmark.
+ count is # of calls (or moves, games) done in seconds. checksum is made from the results, so it is the same for every build which plays the same.
+ */
+typedef struct _RESULT {
+    const char *name;
+    const char *unit;
+    int threads;
+    long long count;
+    double seconds;
+    double efficiency;          // Scaling efficiency compared to 1 thread. (Only for scaling)
+    double p99;                 // 99th percentile of seconds of a call. (Only for latency)
+    uint64_t checksum;
+} RESULT;
+
+// Fixed weights of benchmark. They are the weights of a trained individual.
+const double benchWeight[NUM_OF_WEIGHTS] = {-4.960563, -4.917595, -0.018812, 1.040119, 1.285719, 4.085517, -2.844361, 0.509945};
+
+double MIN_TIME = 0.5;          // Minimum seconds of each kernel benchmark.
+vector<FIELD> corpus;           // Fields of the middle of games.
+vector<RESULT> results;
+
+/*
+ Makes the corpus of fields by playing games with fixed weights and seed.
+ Every field before each block is stored, so the corpus has fields of various heights.
+ */
+void makeCorpus(uint64_t seed) {
+    int i, blockRotate, blockY, blockX, blockQueue[MAX_BLOCK_NUM], game = 0;
+    static NODE node[MAX_BLOCK_NUM + 1];
+    FIELD field;
+    RANDOM rng;
+    SEARCH search;
+    
+    search.weight = benchWeight;
+    search.simd = false;        // Both versions give the same scores, so the corpus doesn't depend on CPU.
+    search.rng = &rng;
+    search.depth = 1;
+    search.beamWidth = 0;
+    search.table = (TRANSPOSITION*)calloc(SIZE_OF_TRANSPOSITION, sizeof(TRANSPOSITION));
+    search.stamp = 0;
+    search.countOfNode = 0;
+    while((int)corpus.size() < SIZE_OF_CORPUS) {
+        initRandom(&rng, splitSeed(seed, game++));
+        initField(&field);
+        for(i = 0; i < (int)corpus.size() % 200 + 50 && (int)corpus.size() < SIZE_OF_CORPUS; i++) {
+            blockQueue[0] = randomInt(&rng, NUM_OF_SHAPE);
+            node[0].recField = field;
+            getRecommendedPlay(&node[0], &blockRotate, &blockY, &blockX, blockQueue, &search);
+            if(blockY <= boundary[blockQueue[0]][blockRotate].y1 - 1) break;
+            corpus.push_back(field);
+            addBlockToField(&field, blockQueue[0], blockRotate, blockY, blockX);
+            deleteLineFromField(&field);
+        }
+    }
+    free(search.table);
+}
+
+void addResult(const char *name, const char *unit, int threads, long long count, double seconds, uint64_t checksum) {
+    RESULT r = {name, unit, threads, count, seconds, 0, 0, checksum};
+    results.push_back(r);
+}
+
+/*
+ checkBlockCanMove() for every shape, rotation and position of block on every field of corpus.
+ */
+void benchCheckBlockCanMove() {
+    int id, r, x, y;
+    long long count = 0;
+    uint64_t checksum = 0;
+    double startTime = omp_get_wtime();
+    do {
+        checksum = 0;
+        for(const FIELD &f : corpus)
+            for(id = 0; id < NUM_OF_SHAPE; id++)
+                for(r = 0; r < NUM_OF_ROTATE; r++)
+                    for(x = boundary[id][r].x1; x <= boundary[id][r].x2; x++)
+                        for(y = boundary[id][r].y1; y <= boundary[id][r].y2; y++) {
+                            checksum += checkBlockCanMove(&f, id, r, y, x);
+                            count++;
+                        }
+    } while(omp_get_wtime() - startTime < MIN_TIME);
+    addResult("checkBlockCanMove", "calls", 1, count, omp_get_wtime() - startTime, checksum);
+}
+
+/*
+ addBlockToField() and deleteLineFromField() for every play of every shape on every field of corpus.
+ Fields after adding blocks are stored, and lines of them are deleted separately. (Both include copying the field.)
+ */
+void benchAddAndDeleteLine() {
+    int id, r, x;
+    size_t k;
+    long long count = 0;
+    uint64_t checksum = 0;
+    vector<FIELD> added;
+    FIELD f;
+    double startTime;
+    
+    for(const FIELD &g : corpus)
+        for(id = 0; id < NUM_OF_SHAPE; id++)
+            for(r = 0; r < rotateNum[id]; r++)
+                for(x = boundary[id][r].x1; x <= boundary[id][r].x2; x++)
+                    added.push_back(g);
+    startTime = omp_get_wtime();
+    do {
+        checksum = 0;
+        k = 0;
+        for(const FIELD &g : corpus)
+            for(id = 0; id < NUM_OF_SHAPE; id++)
+                for(r = 0; r < rotateNum[id]; r++)
+                    for(x = boundary[id][r].x1; x <= boundary[id][r].x2; x++) {
+                        added[k] = g;
+                        checksum += addBlockToField(&added[k++], id, r, getLandingY(&g, id, r, x), x);
+                    }
+        count += k;
+    } while(omp_get_wtime() - startTime < MIN_TIME);
+    addResult("addBlockToField", "calls", 1, count, omp_get_wtime() - startTime, checksum);
+    
+    count = 0;
+    startTime = omp_get_wtime();
+    do {
+        checksum = 0;
+        for(k = 0; k < added.size(); k++) {
+            f = added[k];
+            checksum += deleteLineFromField(&f) + f.sumOfHeight;
+        }
+        count += k;
+    } while(omp_get_wtime() - startTime < MIN_TIME);
+    addResult("deleteLineFromField", "calls", 1, count, omp_get_wtime() - startTime, checksum);
+}
+
+/*
+ scoreFeature() for features of every shape on every field of corpus, and getRecommendedPlay() for every field of corpus.
+ Features are made by the search of depth 1 in advance, so only scoring is measured.
+ */
+void benchScoreAndSearch(const CONFIG *config) {
+    int i, blockRotate, blockY, blockX, blockQueue[MAX_BLOCK_NUM];
+    size_t k;
+    long long count = 0;
+    uint64_t checksum = 0;
+    double score;
+    static NODE node[MAX_BLOCK_NUM + 1];
+    static FEATURE feature[SIZE_OF_CORPUS];     // FEATURE is aligned for SIMD, so it is not stored in vector.
+    static int countOfFeature[SIZE_OF_CORPUS];
+    RANDOM rng;
+    SEARCH search;
+    double startTime;
+    
+    initRandom(&rng, config->seed);
+    search.weight = benchWeight;
+    search.simd = checkSIMD(config->simd);
+    search.rng = &rng;
+    search.depth = 1;
+    search.beamWidth = 0;
+    search.table = (TRANSPOSITION*)calloc(SIZE_OF_TRANSPOSITION, sizeof(TRANSPOSITION));
+    search.stamp = 0;
+    search.countOfNode = 0;
+    for(k = 0; k < corpus.size(); k++) {
+        blockQueue[0] = k % NUM_OF_SHAPE;
+        node[0].recField = corpus[k];
+        getRecommendedPlay(&node[0], &blockRotate, &blockY, &blockX, blockQueue, &search);
+        feature[k] = node[0].feature;
+        countOfFeature[k] = node[0].countOfCandidate;
+    }
+    startTime = omp_get_wtime();
+    do {
+        score = 0;
+        for(k = 0; k < corpus.size(); k++) score += scoreFeature(&feature[k], countOfFeature[k], benchWeight, search.simd);
+        count += k;
+    } while(omp_get_wtime() - startTime < MIN_TIME);
+    memcpy(&checksum, &score, sizeof(checksum));      // Bits of the sum, so SIMD and scalar versions should give the same checksum.
+    addResult("scoreFeature", "batches", 1, count, omp_get_wtime() - startTime, checksum);
+    
+    // Search of configured depth. Blocks of queue are fixed by the index of field.
+    search.depth = config->depth;
+    search.beamWidth = config->beamWidth;
+    count = 0;
+    startTime = omp_get_wtime();
+    do {
+        checksum = 0;
+        initRandom(&rng, config->seed);
+        for(k = 0; k < corpus.size(); k++) {
+            for(i = 0; i < search.depth; i++) blockQueue[i] = (k + i * 3) % NUM_OF_SHAPE;
+            node[0].recField = corpus[k];
+            getRecommendedPlay(&node[0], &blockRotate, &blockY, &blockX, blockQueue, &search);
+            checksum = checksum * 31 + blockRotate * WIDTH * HEIGHT + blockY * WIDTH + blockX;
+        }
+        count += k;
+    } while(omp_get_wtime() - startTime < MIN_TIME);
+    addResult("getRecommendedPlay", "moves", 1, count, omp_get_wtime() - startTime, checksum);
+    free(search.table);
+}
+
+/*
+ recommendPlay() of bot for every field of corpus one by one, and recommendPlays() for the whole corpus at once.
+ Requests are the same as getRecommendedPlay(), and the latency of each call is measured for the 99th percentile.
+ */
+void benchBot(const CONFIG *config) {
+    int i;
+    size_t k;
+    long long count = 0;
+    uint64_t checksum = 0;
+    vector<BOT_REQUEST> request(corpus.size());
+    vector<BOT_PLAY> play(corpus.size());
+    vector<double> latency;
+    double startTime, callTime;
+    BOT *bot = createBot(benchWeight, config->depth, config->beamWidth, config->seed);
+    
+    for(k = 0; k < corpus.size(); k++) {
+        memcpy(request[k].line, corpus[k].line, sizeof(request[k].line));
+        for(i = 0; i < config->depth; i++) request[k].blockQueue[i] = (k + i * 3) % NUM_OF_SHAPE;
+        request[k].countOfBlock = config->depth;
+    }
+    startTime = omp_get_wtime();
+    do {
+        checksum = 0;
+        initRandom(&bot->rng, config->seed);
+        for(k = 0; k < corpus.size(); k++) {
+            callTime = omp_get_wtime();
+            recommendPlay(bot, &request[k], &play[k]);
+            latency.push_back(omp_get_wtime() - callTime);
+            checksum = checksum * 31 + play[k].blockRotate * WIDTH * HEIGHT + play[k].blockY * WIDTH + play[k].blockX;
+        }
+        count += k;
+    } while(omp_get_wtime() - startTime < MIN_TIME);
+    addResult("recommendPlay", "moves", 1, count, omp_get_wtime() - startTime, checksum);
+    nth_element(latency.begin(), latency.begin() + latency.size() * 99 / 100, latency.end());
+    results.back().p99 = latency[latency.size() * 99 / 100];
+    
+    count = 0;
+    startTime = omp_get_wtime();
+    do {
+        initRandom(&bot->rng, config->seed);
+        checksum = recommendPlays(bot, &request[0], corpus.size(), &play[0]);
+        for(k = 0; k < corpus.size(); k++)
+            checksum = checksum * 31 + play[k].blockRotate * WIDTH * HEIGHT + play[k].blockY * WIDTH + play[k].blockX;
+        count += k;
+    } while(omp_get_wtime() - startTime < MIN_TIME);
+    addResult("recommendPlays", "moves", 1, count, omp_get_wtime() - startTime, checksum);
+    freeBot(bot);
+}
+
+/*
+ Plays games with fixed weights and seed on 1 thread, and measures moves per second and games per second.
+ */
+void benchPlay(const CONFIG *config) {
+    int i;
+    long long moves = 0;
+    GAME_STAT stat;
+    uint64_t checksum = 0;
+    RANDOM rng;
+    GAME_OPTION option;
+    double startTime, seconds;
+    
+    option.width = config->width;
+    option.height = config->height;
+    option.depth = config->depth;
+    option.beamWidth = config->beamWidth;
+    option.limitOfPiece = config->maxPiece;
+    startTime = omp_get_wtime();
+    for(i = 0; i < NUM_OF_BENCH_GAME; i++) {
+        initRandom(&rng, splitSeed(config->seed, i));
+        checksum += playTetris(benchWeight, &option, NULL, &rng, NULL, &stat);
+        moves += stat.countOfPiece;
+    }
+    seconds = omp_get_wtime() - startTime;
+    addResult("playTetris", "moves", 1, moves, seconds, checksum);
+    addResult("playTetris", "games", 1, NUM_OF_BENCH_GAME, seconds, checksum);
+}
+
+/*
+ Evaluates one generation with 1 ~ maximum threads, and measures the scaling efficiency.
+ Every run evaluates the same population with the same seed, so they do the same work.
+ Generations are measured by runGenerations() of 1 island, so steady state is turned off. (Children would be evaluated forever.)
+ Games are played by local threads, so remote workers are not used even if '-listen' is given.
+ */
+void benchScaling(const CONFIG *config) {
+    int i, threads;
+    long long pieces;
+    uint64_t checksum;
+    double startTime, seconds, baseSeconds = 0;
+    CONFIG c = *config;
+    
+    c.countOfIsland = 1;
+    c.maxGeneration = 0;
+    c.resumeFile = NULL;
+    c.steadyState = false;
+    c.listenPort = 0;
+    for(threads = 1; threads <= config->threadCount; threads++) {
+        c.threadCount = threads;
+        initTraining(&c);
+        startTime = omp_get_wtime();
+        runGenerations(&c, NULL);
+        seconds = omp_get_wtime() - startTime;
+        const TELEMETRY *telemetry = &islands[0].history[0].telemetry;
+        pieces = 0;
+        checksum = 0;
+        for(i = 0; i < c.countOfPopulation; i++) {
+            pieces += telemetry->individual[i].countOfPiece;
+            checksum += (uint64_t)(telemetry->score[i] * c.countOfPlay + 0.5);
+        }
+        if(threads == 1) baseSeconds = seconds;
+        addResult("evaluatePopulation", "pieces", threads, pieces, seconds, checksum);
+        results.back().efficiency = baseSeconds / (seconds * threads);
+    }
+    freeIslands();
+}
+
+void printJSON(const CONFIG *config) {
+    size_t i;
+    printf("{\n  \"seed\": %llu,\n  \"board\": \"%dx%d\",\n  \"depth\": %d,\n  \"beam\": %d,\n  \"simd\": %s,\n  \"results\": [\n",
+           (unsigned long long)config->seed, config->width, config->height, config->depth, config->beamWidth, checkSIMD(config->simd) ? "true" : "false");
+    for(i = 0; i < results.size(); i++) {
+        RESULT *r = &results[i];
+        printf("    {\"name\": \"%s\", \"unit\": \"%s\", \"threads\": %d, \"count\": %lld, \"seconds\": %.6lf, \"perSecond\": %.1lf, \"efficiency\": %.3lf, \"p99Micros\": %.3lf, \"checksum\": %llu}%s\n",
+               r->name, r->unit, r->threads, r->count, r->seconds, r->count / r->seconds, r->efficiency, r->p99 * 1e6, (unsigned long long)r->checksum, i + 1 < results.size() ? "," : "");
+    }
+    printf("  ]\n}\n");
+}
+
+void printCSV() {
+    printf("name,unit,threads,count,seconds,perSecond,efficiency,p99Micros,checksum\n");
+    for(RESULT &r : results)
+        printf("%s,%s,%d,%lld,%.6lf,%.1lf,%.3lf,%.3lf,%llu\n", r.name, r.unit, r.threads, r.count, r.seconds, r.count / r.seconds, r.efficiency, r.p99 * 1e6, (unsigned long long)r.checksum);
+}
+
+/*
+ Benchmark of engine kernels and training throughput.
+ Results are printed as JSON (or CSV with '-csv'), so builds can be compared.
+ Checksums depend only on the results, so they should be the same for every build.
+ */
+int main(int argc, char *argv[]) {
+    int i;
+    bool csv = false;
+    CONFIG config;
+    
+    initConfig(&config);
+    config.seed = 1;
+    config.maxPiece = 1000;
+    config.pieceBudget = 100000;
+    for(i = 1; i < argc; i++) {
+        if(parseConfig(&config, argc, argv, &i)) continue;
+        else if(strcmp(argv[i], "-csv") == 0) csv = true;
+        else if(strcmp(argv[i], "-time") == 0 && i < argc - 1) MIN_TIME = atof(argv[++i]);
+        else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    
+    initTetris(config.simd);
+    makeCorpus(config.seed);
+    benchCheckBlockCanMove();
+    benchAddAndDeleteLine();
+    benchScoreAndSearch(&config);
+    benchBot(&config);
+    benchPlay(&config);
+    benchScaling(&config);
+    if(csv) printCSV();
+    else printJSON(&config);
+    return 0;
+}
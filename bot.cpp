@@ -0,0 +1,90 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bot.h"
+
+using namespace std;
+
+/*
+ Parses the weights of factors from text. Text can be a line of 'output.txt' ('Gen 3 : ...' or 'Island 2 Gen 3 : ...') or just the weights.
+ It returns false if text doesn't have NUM_OF_WEIGHTS numbers.
+ */
+bool parseWeights(const char *text, double weight[NUM_OF_WEIGHTS]) {
+    int i;
+    char *end;
+    const char *p = strchr(text, ':');
+    p = p != NULL ? p + 1 : text;
+    for(i = 0; i < NUM_OF_WEIGHTS; i++) {
+        weight[i] = strtod(p, &end);
+        if(end == p) return false;
+        p = end;
+    }
+    return true;
+}
+
+/*
+ Creates a bot which looks ahead depth blocks (1 ~ MAX_BLOCK_NUM) with beamWidth best plays of each level (0: all plays).
+ Weights are copied, so they can be freed after this. seed is the seed of generator for plays with the same score.
+ Bot is allocated at once with everything the search needs, so requests don't allocate memory. It returns NULL if memory is not enough.
+ */
+BOT *createBot(const double weight[NUM_OF_WEIGHTS], int depth, int beamWidth, uint64_t seed) {
+    // Features of nodes are aligned for SIMD, so bot is allocated with the alignment of them.
+    BOT *bot = (BOT*)aligned_alloc(alignof(BOT), sizeof(BOT));
+    if(bot == NULL) return NULL;
+    memset(bot->table, 0, sizeof(bot->table));
+    memcpy(bot->weight, weight, sizeof(bot->weight));
+    initRandom(&bot->rng, seed);
+    bot->depth = depth < 1 ? 1 : (depth > MAX_BLOCK_NUM ? MAX_BLOCK_NUM : depth);
+    bot->search.weight = bot->weight;
+    bot->search.simd = checkSIMD(true);
+    bot->search.rng = &bot->rng;
+    bot->search.depth = bot->depth;
+    bot->search.beamWidth = beamWidth < 0 ? 0 : beamWidth;
+    bot->search.table = bot->table;
+    bot->search.stamp = 0;
+    bot->search.countOfNode = 0;
+    return bot;
+}
+
+void freeBot(BOT *bot) {
+    free(bot);
+}
+
+/*
+ Recommends the play of current block of request by the same search as playTetris().
+ Blocks beyond the depth of bot are ignored, and fewer blocks than the depth are looked ahead as they are.
+ If the best play gets out of the top of field, the game is over as playTetris() and the status is BOT_GAME_OVER.
+ */
+void recommendPlay(BOT *bot, const BOT_REQUEST *request, BOT_PLAY *play) {
+    int i;
+    int blockQueue[MAX_BLOCK_NUM];
+    
+    play->status = BOT_INVALID;
+    play->blockRotate = play->blockY = play->blockX = -1;
+    if(request->countOfBlock < 1) return;
+    for(i = 0; i < HEIGHT; i++)
+        if((request->line[i] & ~FULL_LINE) != 0 || request->line[i] == FULL_LINE) return;
+    bot->search.depth = request->countOfBlock < bot->depth ? request->countOfBlock : bot->depth;
+    for(i = 0; i < bot->search.depth; i++) {
+        if(request->blockQueue[i] < 0 || request->blockQueue[i] >= NUM_OF_SHAPE) return;
+        blockQueue[i] = request->blockQueue[i];
+    }
+    
+    initFieldFromLines(&bot->node[0].recField, request->line);
+    getRecommendedPlay(&bot->node[0], &play->blockRotate, &play->blockY, &play->blockX, blockQueue, &bot->search);
+    play->status = play->blockY <= boundary[blockQueue[0]][play->blockRotate].y1 - 1 ? BOT_GAME_OVER : BOT_OK;
+}
+
+/*
+ Recommends the plays of count requests in order with the same bot. It is a convenience wrapper of recommendPlay():
+ each request has its own field and blocks, so it is checked and searched as a single request, and only the bot is shared.
+ It returns the number of requests whose status is BOT_OK.
+ */
+int recommendPlays(BOT *bot, const BOT_REQUEST *request, int count, BOT_PLAY *play) {
+    int i, countOfPlay = 0;
+    for(i = 0; i < count; i++) {
+        recommendPlay(bot, &request[i], &play[i]);
+        if(play[i].status == BOT_OK) countOfPlay++;
+    }
+    return countOfPlay;
+}
@@ -0,0 +1,49 @@
+#ifndef bot_h
+#define bot_h
+
+#include "tetris.h"
+
+#define BOT_OK 0                // Play is recommended.
+#define BOT_GAME_OVER 1         // Current block gets out of the field by any play, so the game is over.
+#define BOT_INVALID 2           // Request is invalid. (Unknown block, no block, or line which is complete or out of the field)
+
+/*
+ Bot which recommends plays on the default board (WIDTH x HEIGHT) with trained weights, for embedding them in other programs.
+ It owns everything the search needs (weights, stack of nodes, transposition table and generator), and the engine has no global state,
+ so bots on different threads never share anything. A bot should be used by only one thread at once: create one bot per thread.
+ Plays with the same score are chosen by the generator of bot, so the same requests in the same order get the same plays.
+ */
+typedef struct _BOT {
+    NODE node[MAX_BLOCK_NUM + 1];                       // Stack of nodes of state space tree. ([0]: Root node)
+    TRANSPOSITION table[SIZE_OF_TRANSPOSITION];         // Transposition table of search.
+    double weight[NUM_OF_WEIGHTS];                      // Weights of factors.
+    RANDOM rng;                                         // Generator for choosing one of plays with the same score.
+    int depth;                                          // Maximum # of blocks to look ahead.
+    SEARCH search;
+} BOT;
+
+/*
+ Request of play. It is the state of game which is sent by game server.
+ */
+typedef struct _BOT_REQUEST {
+    unsigned short line[HEIGHT];        // Field as bit masks. (Bit j of line[i] is set if the cell of i-th row and j-th column is filled. Row 0 is the top.)
+    int blockQueue[MAX_BLOCK_NUM];      // Blocks to be played. ([0]: Current block, [1]: Next block, ...) Blocks are the indexes of shapes of block table.
+    int countOfBlock;                   // # of blocks in queue. Blocks beyond the depth of bot are not looked ahead.
+} BOT_REQUEST;
+
+/*
+ Recommended play of current block of request.
+ Rotation and position are the same as plays of playTetris(): block[blockQueue[0]][blockRotate] is placed with its top-left cell at (blockY, blockX).
+ */
+typedef struct _BOT_PLAY {
+    int status;                         // BOT_OK, BOT_GAME_OVER or BOT_INVALID. Play is valid only if it is BOT_OK.
+    int blockRotate, blockY, blockX;
+} BOT_PLAY;
+
+bool parseWeights(const char *text, double weight[NUM_OF_WEIGHTS]);
+BOT *createBot(const double weight[NUM_OF_WEIGHTS], int depth, int beamWidth, uint64_t seed);
+void freeBot(BOT *bot);
+void recommendPlay(BOT *bot, const BOT_REQUEST *request, BOT_PLAY *play);
+int recommendPlays(BOT *bot, const BOT_REQUEST *request, int count, BOT_PLAY *play);     // Calls recommendPlay() for each request in order.
+
+#endif
@@ -0,0 +1,916 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <algorithm>
+#include <unistd.h>
+#include <omp.h>
+#include "genetic.h"
+#include "remote.h"
+
+using namespace std;
+
+vector<ISLAND> islands;
+
+/*
+ Comparison function for compare the fitness of two individuals.
+ This function will compare the game score of them. Individuals dropped by racing are always worse than individuals which played every game,
+ because the average of their first games is not comparable with the average of all games.
+ */
+bool individualLessFunction(struct _INDIVIDUAL a, struct _INDIVIDUAL b) {
+    if(a.dropped != b.dropped) return b.dropped;
+    if(a.score > b.score) return true;
+    return false;
+}
+
+/*
+ Sets the default options.
+ */
+void initConfig(CONFIG *config) {
+    config->threadCount = omp_get_num_procs();
+    config->seed = (uint64_t)time(NULL);
+    config->maxGeneration = 0;
+    config->countOfPopulation = NUM_OF_POPULATION;
+    config->countOfTop = NUM_OF_TOP_POPULATION;
+    config->countOfIsland = 1;
+    config->migrationInterval = MIGRATION_INTERVAL;
+    config->countOfMigrant = NUM_OF_MIGRANT;
+    config->countOfPlay = NUM_OF_PLAY;
+    config->raceRound = 0;
+    config->steadyState = false;
+    config->fitnessCache = false;
+    config->maxPiece = 0;
+    config->pieceBudget = 0;
+    config->width = WIDTH;
+    config->height = HEIGHT;
+    config->depth = BLOCK_NUM;
+    config->beamWidth = 0;
+    config->simd = true;
+    config->logFile = NULL;
+    config->checkpointInterval = 0;
+    config->checkpointFile = "checkpoint.bin";
+    config->resumeFile = NULL;
+    config->listenPort = 0;
+}
+
+/*
+ Parses the size of board. (WIDTH x HEIGHT, for example '10x20')
+ It returns false if the engine is not compiled for the board.
+ */
+bool parseBoard(CONFIG *config, const char *value) {
+    int width, height;
+    if(sscanf(value, "%dx%d", &width, &height) != 2 || !checkBoard(width, height)) {
+        fprintf(stderr, "Unsupported board: %s (Boards:%s)\n", value, BOARD_NAMES);
+        return false;
+    }
+    config->width = width;
+    config->height = height;
+    return true;
+}
+
+/*
+ Parses the command line option argv[*i].
+ It returns true if the option is an option of machine learning. If the option has a value, *i is moved to the value.
+ */
+bool parseConfig(CONFIG *config, int argc, char *argv[], int *i) {
+    char *option = argv[*i];
+    bool hasValue = *i < argc - 1;
+    if(strcmp(option, "-t") == 0 && hasValue) config->threadCount = max(1, (int)strtol(argv[++*i], NULL, 10));
+    else if(strcmp(option, "--seed") == 0 && hasValue) config->seed = strtoull(argv[++*i], NULL, 10);
+    else if(strcmp(option, "-gen") == 0 && hasValue) config->maxGeneration = max(0, (int)strtol(argv[++*i], NULL, 10));
+    else if(strcmp(option, "-pop") == 0 && hasValue) config->countOfPopulation = max(2, (int)strtol(argv[++*i], NULL, 10));
+    else if(strcmp(option, "-top") == 0 && hasValue) config->countOfTop = max(1, (int)strtol(argv[++*i], NULL, 10));
+    else if(strcmp(option, "-island") == 0 && hasValue) config->countOfIsland = max(1, (int)strtol(argv[++*i], NULL, 10));
+    else if(strcmp(option, "-migrate") == 0 && hasValue) config->migrationInterval = max(1, (int)strtol(argv[++*i], NULL, 10));
+    else if(strcmp(option, "-migrant") == 0 && hasValue) config->countOfMigrant = max(0, (int)strtol(argv[++*i], NULL, 10));
+    else if(strcmp(option, "-games") == 0 && hasValue) config->countOfPlay = max(1, (int)strtol(argv[++*i], NULL, 10));
+    else if(strcmp(option, "-race") == 0 && hasValue) config->raceRound = max(2, (int)strtol(argv[++*i], NULL, 10));
+    else if(strcmp(option, "-steady") == 0) config->steadyState = true;
+    else if(strcmp(option, "-cache") == 0) config->fitnessCache = true;
+    else if(strcmp(option, "-maxpiece") == 0 && hasValue) config->maxPiece = max(0, (int)strtol(argv[++*i], NULL, 10));
+    else if(strcmp(option, "-genpiece") == 0 && hasValue) config->pieceBudget = max(0LL, strtoll(argv[++*i], NULL, 10));
+    else if(strcmp(option, "-board") == 0 && hasValue && parseBoard(config, argv[*i + 1])) ++*i;
+    else if(strcmp(option, "-depth") == 0 && hasValue) config->depth = min(MAX_BLOCK_NUM, max(1, (int)strtol(argv[++*i], NULL, 10)));
+    else if(strcmp(option, "-beam") == 0 && hasValue) config->beamWidth = max(0, (int)strtol(argv[++*i], NULL, 10));
+    else if(strcmp(option, "-nosimd") == 0) config->simd = false;
+    else if(strcmp(option, "-log") == 0 && hasValue) config->logFile = argv[++*i];
+    else if(strcmp(option, "-checkpoint") == 0 && hasValue) config->checkpointInterval = max(0, (int)strtol(argv[++*i], NULL, 10));
+    else if(strcmp(option, "--resume") == 0 && hasValue) config->resumeFile = config->checkpointFile = argv[++*i];
+    else if(strcmp(option, "-listen") == 0 && hasValue) config->listenPort = max(0, (int)strtol(argv[++*i], NULL, 10));
+    else return false;
+    return true;
+}
+
+/*
+ Makes options consistent with each other. Racing needs rounds of 2 or more games, so it is turned off if there are fewer games.
+ Options of checkpoints are checked by readCheckpoint() with the same ranges.
+ */
+void checkConfig(CONFIG *config) {
+    config->countOfTop = min(config->countOfTop, config->countOfPopulation);
+    config->countOfMigrant = min(config->countOfMigrant, config->countOfPopulation - 1);
+    config->raceRound = min(config->raceRound, config->countOfPlay);
+    if(config->raceRound < 2) config->raceRound = 0;
+}
+
+/*
+ Creates islands of the first generation without individuals.
+ The first island uses the seed of the whole run, so learning with 1 island is the same as learning without islands.
+ */
+void initIslands(const CONFIG *config) {
+    int k, j;
+    freeIslands();
+    islands.resize(config->countOfIsland);
+    for(k = 0; k < config->countOfIsland; k++) {
+        ISLAND *island = &islands[k];
+        island->population.assign(config->countOfPopulation, INDIVIDUAL());
+        island->gen = 1;
+        island->seed = k == 0 ? config->seed : splitSeed(config->seed, ~(uint64_t)k);
+        initRandom(&island->rng, island->seed);
+        island->sequence = new PIECE_SEQUENCE[config->countOfPlay];
+        island->countOfSequence = config->countOfPlay;
+        for(j = 0; j < config->countOfPlay; j++) initPieceSequence(&island->sequence[j]);
+        island->fitnessCache.assign(config->fitnessCache ? SIZE_OF_FITNESS_CACHE : 0, FITNESS());
+        island->history.clear();
+        island->countOfChild = 0;
+    }
+}
+
+/*
+ Frees the blocks of games of islands and removes every island.
+ */
+void freeIslands() {
+    int j;
+    for(ISLAND &island : islands) {
+        for(j = 0; j < island.countOfSequence; j++) freePieceSequence(&island.sequence[j]);
+        delete[] island.sequence;
+    }
+    islands.clear();
+}
+
+/*
+ Generate random chromosomes for the first generation. (Initialization)
+ We can assume some factors might be good for playing Tetris, but some factors are not.
+ - Bad factors: 'Sum of heights of each column of field', '# of holes', '# of blockades' and 'SD of heights of field'.
+ - Good factors: 'Gotten score by reaching block to the floor', 'Gotten score by removing lines' and '# of blocks reached at wall'
+ Therefore, we make that bad factors as negative number and good factors as positive number to prevent stuck in local minima.
+ */
+void initPopulation(ISLAND *island) {
+    int j;
+    for(INDIVIDUAL &individual : island->population) {
+        for(j = 0; j < NUM_OF_WEIGHTS; j++) {
+            individual.weight[j] = randomDouble(&island->rng) * 5.0;
+            if((j == 0 || j == 1 || j == 2 || j == 6) && individual.weight[j] > 0) individual.weight[j] = -individual.weight[j];
+            if((j == 3 || j == 4 || j == 5) && individual.weight[j] < 0) individual.weight[j] = -individual.weight[j];
+        }
+        individual.score = 0;
+        individual.dropped = false;
+    }
+}
+
+/*
+ Prepares the first generation to learn.
+ If config->resumeFile is set, the islands and options of learning are restored from the checkpoint.
+ Otherwise, random population of each island is generated by the seed. It returns false if the checkpoint can't be read.
+ */
+bool initTraining(CONFIG *config) {
+    checkConfig(config);
+    if(config->resumeFile != NULL) return readCheckpoint(config->resumeFile, config);
+    initIslands(config);
+    for(ISLAND &island : islands) initPopulation(&island);
+    return true;
+}
+
+/*
+ Writes the state of learning to the file. The state is written at the beginning of a generation (after breedPopulation()).
+ It contains options which change the result of learning, the interval of checkpoints, and population, generation,
+ generator for crossover and mutation, and fitness cache of each island. In steady state, children which are being evaluated are not written.
+ The state is written to the temporary file first and renamed, so the file always has a complete checkpoint even if the process is killed.
+ */
+bool writeCheckpoint(const char *fileName, const CONFIG *config) {
+    char tempFileName[4096];
+    uint32_t header[4] = {CHECKPOINT_MAGIC, CHECKPOINT_VERSION, NUM_OF_WEIGHTS, sizeof(INDIVIDUAL)};
+    int32_t option[15] = {config->maxPiece, config->depth, config->beamWidth, config->countOfPlay, config->raceRound, config->fitnessCache,
+                          config->countOfPopulation, config->countOfTop, config->countOfIsland, config->migrationInterval, config->countOfMigrant, config->steadyState,
+                          config->width, config->height, config->checkpointInterval};
+    int64_t pieceBudget = config->pieceBudget;
+    uint64_t seed = config->seed;
+    int32_t gen[2];
+    bool success;
+    FILE *outf;
+
+    snprintf(tempFileName, sizeof(tempFileName), "%s.tmp", fileName);
+    outf = fopen(tempFileName, "wb");
+    if(outf == NULL) return false;
+    success = fwrite(header, sizeof(header), 1, outf) == 1
+           && fwrite(&seed, sizeof(seed), 1, outf) == 1
+           && fwrite(&pieceBudget, sizeof(pieceBudget), 1, outf) == 1
+           && fwrite(option, sizeof(option), 1, outf) == 1;
+    for(ISLAND &island : islands) {
+        gen[0] = island.gen;
+        gen[1] = island.countOfChild;
+        success = success
+               && fwrite(gen, sizeof(gen), 1, outf) == 1
+               && fwrite(island.rng.s, sizeof(island.rng.s), 1, outf) == 1
+               && fwrite(island.population.data(), sizeof(INDIVIDUAL), island.population.size(), outf) == island.population.size()
+               && fwrite(island.fitnessCache.data(), sizeof(FITNESS), island.fitnessCache.size(), outf) == island.fitnessCache.size();
+    }
+    success = success && fflush(outf) == 0 && fsync(fileno(outf)) == 0;
+    if(fclose(outf) != 0) success = false;
+    if(success && rename(tempFileName, fileName) == 0) return true;
+    remove(tempFileName);
+    return false;
+}
+
+/*
+ Reads the state of learning written by writeCheckpoint().
+ Options which change the result of learning are overwritten by the checkpoint, so the learning continues exactly the same.
+ Other options (threads, generations, log) are kept. The interval of checkpoints is kept if it is given, otherwise the interval of the checkpoint is used.
+ It returns false if the file is not a complete checkpoint of this program, or its options are out of range.
+ */
+bool readCheckpoint(const char *fileName, CONFIG *config) {
+    uint32_t header[4];
+    int32_t option[15];
+    int64_t pieceBudget;
+    uint64_t seed;
+    int32_t gen[2];
+    CONFIG c = *config;
+    bool success;
+    FILE *inf = fopen(fileName, "rb");
+
+    if(inf == NULL) return false;
+    success = fread(header, sizeof(header), 1, inf) == 1
+           && header[0] == CHECKPOINT_MAGIC && header[1] == CHECKPOINT_VERSION && header[2] == NUM_OF_WEIGHTS && header[3] == sizeof(INDIVIDUAL)
+           && fread(&seed, sizeof(seed), 1, inf) == 1
+           && fread(&pieceBudget, sizeof(pieceBudget), 1, inf) == 1
+           && fread(option, sizeof(option), 1, inf) == 1
+           && pieceBudget >= 0 && option[0] >= 0 && option[1] >= 1 && option[1] <= MAX_BLOCK_NUM && option[2] >= 0
+           && option[3] >= 1 && (option[4] == 0 || (option[4] >= 2 && option[4] <= option[3]))
+           && option[6] >= 2 && option[7] >= 1 && option[7] <= option[6] && option[8] >= 1
+           && option[9] >= 1 && option[10] >= 0 && option[10] < option[6] && checkBoard(option[12], option[13]) && option[14] >= 0;
+    if(!success) {
+        fclose(inf);
+        return false;
+    }
+    c.seed = seed;
+    c.pieceBudget = pieceBudget;
+    c.maxPiece = option[0];
+    c.depth = option[1];
+    c.beamWidth = option[2];
+    c.countOfPlay = option[3];
+    c.raceRound = option[4];
+    c.fitnessCache = option[5] != 0;
+    c.countOfPopulation = option[6];
+    c.countOfTop = option[7];
+    c.countOfIsland = option[8];
+    c.migrationInterval = option[9];
+    c.countOfMigrant = option[10];
+    c.steadyState = option[11] != 0;
+    c.width = option[12];
+    c.height = option[13];
+    if(c.checkpointInterval == 0) c.checkpointInterval = option[14];
+    initIslands(&c);
+    for(ISLAND &island : islands) {
+        success = success
+               && fread(gen, sizeof(gen), 1, inf) == 1
+               && fread(island.rng.s, sizeof(island.rng.s), 1, inf) == 1
+               && fread(island.population.data(), sizeof(INDIVIDUAL), island.population.size(), inf) == island.population.size()
+               && fread(island.fitnessCache.data(), sizeof(FITNESS), island.fitnessCache.size(), inf) == island.fitnessCache.size();
+        island.gen = gen[0];
+        island.countOfChild = gen[1];
+    }
+    success = success && fgetc(inf) == EOF;
+    fclose(inf);
+    if(!success) {
+        freeIslands();
+        return false;
+    }
+    *config = c;
+    return true;
+}
+
+/*
+ Writes the checkpoint if a multiple of config->checkpointInterval generations is passed since previousGen.
+ It is called after runGenerations(), or when a generation of the first island is finished in steady state.
+ It returns false only if the checkpoint should be written but couldn't be written.
+ */
+bool saveCheckpoint(const CONFIG *config, int previousGen) {
+    if(config->checkpointInterval == 0 || (islands[0].gen - 1) / config->checkpointInterval == (previousGen - 1) / config->checkpointInterval) return true;
+    return writeCheckpoint(config->checkpointFile, config);
+}
+
+/*
+ Returns the entry of fitness cache of island for the weights. The entry has other weights or is empty if the weights are not cached.
+ */
+FITNESS *findFitness(ISLAND *island, const double *weight) {
+    int i;
+    uint64_t key = 0, bits;
+    for(i = 0; i < NUM_OF_WEIGHTS; i++) {
+        memcpy(&bits, &weight[i], sizeof(bits));
+        key = splitSeed(key, bits);
+    }
+    return &island->fitnessCache[key & (SIZE_OF_FITNESS_CACHE - 1)];
+}
+
+/*
+ Drops individuals which are out of contention for the top config->countOfTop after the first played games of each alive individual.
+ Every individual plays the same games, so individuals are compared by the paired differences of scores of the same games.
+ Individual is dropped if it is worse than countOfTop alive individuals with confidence. (Mean of differences + RACING_CONFIDENCE * standard error < 0)
+ Top countOfTop individuals by average score are never worse than that many individuals, so they are always kept.
+ Only individuals which played every game from the first game race (racing). The others don't have the scores of the same games.
+ scoreOfGame[i * config->countOfPlay + j] is the score of j-th game of i-th individual.
+ */
+void raceIndividual(const CONFIG *config, int played, vector<char> &alive, const vector<char> &racing, const vector<int> &scoreOfGame) {
+    int a, b, j, countOfBetter, n = config->countOfPopulation, g = config->countOfPlay;
+    vector<char> drop(n, false);
+    double mean, variance, d;
+
+    if(played < 2) return;
+    for(a = 0; a < n; a++) {
+        if(!alive[a] || !racing[a]) continue;
+        countOfBetter = 0;
+        for(b = 0; b < n && countOfBetter < config->countOfTop; b++) {
+            if(!alive[b] || !racing[b] || a == b) continue;
+            mean = variance = 0;
+            for(j = 0; j < played; j++) mean += scoreOfGame[a * g + j] - scoreOfGame[b * g + j];
+            mean /= played;
+            for(j = 0; j < played; j++) {
+                d = scoreOfGame[a * g + j] - scoreOfGame[b * g + j] - mean;
+                variance += d * d;
+            }
+            variance /= played - 1;
+            if(mean + RACING_CONFIDENCE * sqrt(variance / played) < 0) countOfBetter++;
+        }
+        drop[a] = countOfBetter >= config->countOfTop;
+    }
+    for(a = 0; a < n; a++)
+        if(drop[a]) alive[a] = false;
+}
+
+/*
+ Sets the options of games of individuals.
+ Budget of generation is divided equally into the games, so every game has the same limit and fitness is the score at the limit.
+ */
+void initGameOption(const CONFIG *config, GAME_OPTION *option) {
+    long long countOfGame = (long long)config->countOfPopulation * config->countOfPlay;
+    option->width = config->width;
+    option->height = config->height;
+    option->depth = config->depth;
+    option->beamWidth = config->beamWidth;
+    option->limitOfPiece = config->maxPiece;
+    if(config->pieceBudget > 0 && (option->limitOfPiece == 0 || config->pieceBudget / countOfGame < option->limitOfPiece))
+        option->limitOfPiece = max(1LL, config->pieceBudget / countOfGame);
+}
+
+/*
+ Plays the games of a round of evaluatePopulation() by remote workers instead of threads.
+ Games of each individual are a job. taskOfRound is sorted by individuals, so games of each individual are consecutive.
+ */
+void playRemoteRound(const CONFIG *config, const ISLAND *island, const GAME_OPTION *option, int countOfTask, const vector<int> &taskOfRound,
+                     vector<int> &scoreOfGame, vector<GAME_STAT> &statOfGame, vector<double> &timeOfGame) {
+    int k, next, g = config->countOfPlay;
+    vector<REMOTE_JOB> job;
+    REMOTE_JOB j;
+    j.seed = splitSeed(island->seed, island->gen);
+    j.option = *option;
+    for(k = 0; k < countOfTask; k = next) {
+        for(next = k + 1; next < countOfTask && taskOfRound[next] / g == taskOfRound[k] / g; next++);
+        j.weight = island->population[taskOfRound[k] / g].weight;
+        j.firstGame = taskOfRound[k] % g;
+        j.countOfGame = next - k;
+        j.score = &scoreOfGame[taskOfRound[k]];
+        j.stat = &statOfGame[taskOfRound[k]];
+        j.time = &timeOfGame[taskOfRound[k]];
+        job.push_back(j);
+    }
+    playRemoteJobs(job.data(), (int)job.size());
+}
+
+/*
+ Evaluates the fitness of each individual of current generation of island by playing games. So, fitness function is just playing tetris.
+ Every individual plays the same games. (Common random numbers) Blocks of j-th game of every individual are the same sequence,
+ so differences of fitness come from the weights rather than luck of blocks, and fewer games (config->countOfPlay) are needed.
+ Each game of each individual is a task. (20 individuals * 20 games)
+ Lengths of games are very different, so tasks are distributed dynamically to idle threads by OpenMP runtime.
+ It should be called in a parallel region, so the games of several islands can be played simultaneously by the same threads.
+ If config->raceRound is set, games are played by rounds of config->raceRound games, and individuals which can't be in the top
+ after a round don't play the remaining games. (Racing) Their fitness is the average of played games, and they are ranked below the others.
+ Individuals with the same weights play only once in a generation. If config->fitnessCache is set, games of the same weights in
+ previous generations are reused from the fitness cache, and only the remaining games are played. Fitness is the average of all games.
+ Time, blocks and nodes of each game and busy time of each thread are recorded in telemetry.
+ If config->listenPort is set, games are played by remote workers. Busy time counts only threads of this process.
+ */
+void evaluatePopulation(const CONFIG *config, ISLAND *island, MONITOR *monitor, TELEMETRY *telemetry) {
+    int i, j, k, n = config->countOfPopulation, g = config->countOfPlay;
+    vector<INDIVIDUAL> &population = island->population;
+    vector<int> scoreOfGame(n * g);                         // Score of each game of each individual. ([individual * g + game])
+    vector<GAME_STAT> statOfGame(n * g);                    // Statistics of each game of each individual.
+    vector<double> timeOfGame(n * g);                       // Seconds of each game of each individual.
+    vector<int> countOfFinishedGame(n, 0);                  // # of finished games of each individual.
+    vector<int> countOfPlayed(n, 0);                        // # of played games of each individual.
+    vector<char> alive(n);                                  // Whether individual plays the next round.
+    vector<char> racing(n);                                 // Whether individual can be dropped by racing.
+    vector<int> original(n);                                // Individual with the same weights which actually plays.
+    vector<FITNESS> cached(n, FITNESS());                   // Games of the weights in fitness cache before the evaluation.
+    vector<int> countOfCached(n, 0);                        // # of games in fitness cache. Games from this index are played.
+    vector<int> taskOfRound(n * g);                         // Games of current round. (individual * g + game)
+    int countOfTask, played, round;
+    RANDOM gameRng;                                         // Generator of each game.
+    GAME_OPTION option;
+    double startTime = omp_get_wtime(), startTimeOfGame;
+
+    initGameOption(config, &option);
+
+    // Sequence of j-th game is derived from the island, generation and game, so it doesn't depend on individuals and threads.
+    for(j = 0; j < g; j++) resetPieceSequence(&island->sequence[j], splitSeed(splitSeed(splitSeed(island->seed, island->gen), j), 0));
+
+    // Each thread adds only its own busy time, so it doesn't need synchronization.
+    telemetry->busyTime.assign(config->threadCount, 0);
+    telemetry->individual.resize(n);
+    telemetry->score.resize(n);
+    telemetry->piece.resize(n);
+    for(i = 0; i < n; i++) {
+        original[i] = i;
+        for(j = 0; j < i; j++) {
+            if(memcmp(population[i].weight, population[j].weight, sizeof(population[i].weight)) == 0) {
+                original[i] = j;
+                break;
+            }
+        }
+        // Entry is copied, because other weights in the same slot can replace it before the games of this individual are added.
+        if(config->fitnessCache && original[i] == i) {
+            FITNESS *cache = findFitness(island, population[i].weight);
+            if(cache->countOfGame > 0 && memcmp(cache->weight, population[i].weight, sizeof(population[i].weight)) == 0) cached[i] = *cache;
+            countOfCached[i] = cached[i].countOfGame;
+        }
+        alive[i] = original[i] == i && countOfCached[i] < g;
+        racing[i] = countOfCached[i] == 0;
+    }
+    round = config->raceRound > 0 ? config->raceRound : g;
+    for(played = 0; played < g; played += round) {
+        round = min(round, g - played);
+        countOfTask = 0;
+        for(i = 0; i < n; i++) {
+            if(!alive[i]) continue;
+            for(j = max(played, countOfCached[i]); j < played + round; j++) {
+                taskOfRound[countOfTask++] = i * g + j;
+                countOfPlayed[i]++;
+            }
+        }
+        if(config->listenPort > 0) {
+            playRemoteRound(config, island, &option, countOfTask, taskOfRound, scoreOfGame, statOfGame, timeOfGame);
+            if(monitor != NULL && monitor->gameFinished != NULL)
+                for(k = 0; k < countOfTask; k++) monitor->gameFinished(monitor->arg, taskOfRound[k] / g, ++countOfFinishedGame[taskOfRound[k] / g]);
+            if(config->raceRound > 0) raceIndividual(config, played + round, alive, racing, scoreOfGame);
+            continue;
+        }
+        // Games are written to the arrays of this evaluation. (They would be copied to each task by default in the task of island.)
+        #pragma omp taskloop grainsize(1) private(i, j, gameRng, startTimeOfGame) shared(scoreOfGame, statOfGame, timeOfGame, countOfFinishedGame)
+        for(k = 0; k < countOfTask; k++)
+        {
+            i = taskOfRound[k] / g;
+            j = taskOfRound[k] % g;
+            // Generator of game (for ties of plays) is also common, so individuals with the same weights play exactly the same.
+            initRandom(&gameRng, splitSeed(splitSeed(splitSeed(island->seed, island->gen), j), 1));
+            startTimeOfGame = omp_get_wtime();
+            scoreOfGame[i * g + j] = playTetris(population[i].weight, &option, &island->sequence[j], &gameRng,
+                                                monitor != NULL && monitor->display != NULL && i < monitor->countOfDisplay ? &monitor->display[i] : NULL, &statOfGame[i * g + j]);
+            timeOfGame[i * g + j] = omp_get_wtime() - startTimeOfGame;
+            telemetry->busyTime[omp_get_thread_num()] += timeOfGame[i * g + j];
+            if(monitor != NULL && monitor->gameFinished != NULL) {
+                int count;
+                #pragma omp atomic capture
+                count = ++countOfFinishedGame[i];
+                monitor->gameFinished(monitor->arg, i, count);
+            }
+        }
+        if(config->raceRound > 0) raceIndividual(config, played + round, alive, racing, scoreOfGame);
+    }
+    telemetry->wallTime = omp_get_wtime() - startTime;
+    // Get the average of scores of played games (and cached games) of each individual.
+    for(i = 0; i < n; i++) {
+        INDIVIDUAL_STAT *stat = &telemetry->individual[i];
+        double sumOfScore = 0;
+        stat->countOfGame = countOfPlayed[i];
+        stat->countOfCachedGame = countOfCached[i];
+        stat->countOfPiece = stat->countOfNode = 0;
+        stat->time = 0;
+        if(original[i] != i) {
+            // The same weights are played by the other individual before this individual.
+            stat->countOfCachedGame = telemetry->individual[original[i]].countOfGame + telemetry->individual[original[i]].countOfCachedGame;
+            population[i].score = population[original[i]].score;
+            population[i].piece = population[original[i]].piece;
+            population[i].dropped = population[original[i]].dropped;
+            telemetry->score[i] = population[i].score;
+            telemetry->piece[i] = population[i].piece;
+            continue;
+        }
+        for(j = countOfCached[i]; j < countOfCached[i] + countOfPlayed[i]; j++) {
+            sumOfScore += scoreOfGame[i * g + j];
+            stat->countOfPiece += statOfGame[i * g + j].countOfPiece;
+            stat->countOfNode += statOfGame[i * g + j].countOfNode;
+            stat->time += timeOfGame[i * g + j];
+        }
+        if(config->fitnessCache) {
+            // Sums of the weights are the copied entry and played games. They are written to the cache, so the entry is replaced if it has other weights.
+            cached[i].sumOfScore += sumOfScore;
+            cached[i].sumOfPiece += stat->countOfPiece;
+            cached[i].countOfGame += countOfPlayed[i];
+            population[i].score = cached[i].sumOfScore / cached[i].countOfGame;
+            population[i].piece = cached[i].sumOfPiece / cached[i].countOfGame;
+            if(countOfPlayed[i] > 0) {
+                memcpy(cached[i].weight, population[i].weight, sizeof(cached[i].weight));
+                *findFitness(island, population[i].weight) = cached[i];
+            }
+        }
+        else {
+            population[i].score = sumOfScore / countOfPlayed[i];
+            population[i].piece = stat->countOfPiece / (double)countOfPlayed[i];
+        }
+        population[i].dropped = countOfCached[i] + countOfPlayed[i] < g;
+        telemetry->score[i] = population[i].score;
+        telemetry->piece[i] = population[i].piece;
+    }
+}
+
+/*
+ Sorts individuals of island by their fitness. population[0] is the best individual.
+ */
+void sortPopulation(ISLAND *island) {
+    sort(island->population.begin(), island->population.end(), individualLessFunction);
+}
+
+/*
+ Plays count generations of k-th island. The last generation is evaluated and sorted, but not bred yet.
+ Result of each generation is added to the history of island and reported to the monitor.
+ */
+void runIsland(const CONFIG *config, int k, MONITOR *monitor, int count) {
+    int i, g;
+    ISLAND *island = &islands[k];
+    GENERATION result;
+    for(g = 0; g < count; g++) {
+        if(g > 0) breedPopulation(config, island);
+        evaluatePopulation(config, island, k == 0 ? monitor : NULL, &result.telemetry);
+        sortPopulation(island);
+        result.gen = island->gen;
+        result.best = island->population[0];
+        result.averageScore = result.averagePiece = 0;
+        for(i = 0; i < config->countOfPopulation; i++) {
+            result.averageScore += island->population[i].score;
+            result.averagePiece += island->population[i].piece;
+        }
+        result.averageScore /= config->countOfPopulation;
+        result.averagePiece /= config->countOfPopulation;
+        island->history.push_back(result);
+        if(monitor != NULL && monitor->generationFinished != NULL) {
+            #pragma omp critical (generationFinished)
+            monitor->generationFinished(monitor->arg, k, &island->history.back());
+        }
+    }
+}
+
+/*
+ Plays generations of every island until the next migration, and breeds the next generation.
+ Islands are tasks, so they don't wait for each other at the end of each generation. Games of all islands are shared by threads.
+ Without islands (1 island), only 1 generation is played.
+ Results of played generations are stored in the history of each island. It returns the number of played generations.
+ In steady state, generations are played until config->maxGeneration by runSteadyState().
+ */
+int runGenerations(const CONFIG *config, MONITOR *monitor) {
+    if(config->steadyState) return runSteadyState(config, monitor);
+    int k, count = config->countOfIsland > 1 ? config->migrationInterval - (islands[0].gen - 1) % config->migrationInterval : 1;
+    if(config->maxGeneration > 0) count = min(count, config->maxGeneration - islands[0].gen + 1);
+    if(count <= 0) return 0;
+    for(ISLAND &island : islands) island.history.clear();
+
+    #pragma omp parallel num_threads(config->threadCount)
+    #pragma omp single
+    for(k = 0; k < config->countOfIsland; k++) {
+        #pragma omp task firstprivate(k)
+        runIsland(config, k, monitor, count);
+    }
+    if(config->countOfIsland > 1 && islands[0].gen % config->migrationInterval == 0) migrateIslands(config);
+    for(ISLAND &island : islands) breedPopulation(config, &island);
+    return count;
+}
+
+/*
+ Sends the best config->countOfMigrant individuals of each island to the next island. (Ring)
+ They replace the worst individuals of the next island, so they can be selected for crossover of the next generation.
+ Populations of islands should be sorted.
+ */
+void migrateIslands(const CONFIG *config) {
+    int k, i, n = config->countOfPopulation, m = config->countOfMigrant;
+    vector<INDIVIDUAL> migrant;
+    for(k = 0; k < config->countOfIsland; k++)
+        for(i = 0; i < m; i++) migrant.push_back(islands[k].population[i]);
+    for(k = 0; k < config->countOfIsland; k++) {
+        ISLAND *next = &islands[(k + 1) % config->countOfIsland];
+        for(i = 0; i < m; i++) next->population[n - m + i] = migrant[k * m + i];
+    }
+    for(ISLAND &island : islands) sortPopulation(&island);
+}
+
+/*
+ Child of steady state which is being evaluated.
+ */
+typedef struct _CHILD {
+    INDIVIDUAL individual;
+    int island;
+    FITNESS cached;                 // Games of the weights in fitness cache when the child is made.
+    double sumOfScore;              // Sum of scores of played games.
+} CHILD;
+
+/*
+ Returns whether k-th island played every generation in steady state.
+ */
+bool isIslandFinished(const CONFIG *config, int k) {
+    return config->maxGeneration > 0 && islands[k].gen > config->maxGeneration;
+}
+
+/*
+ Inserts the evaluated individual into the sorted population of island in steady state.
+ It replaces the worst individual if it is better. Individuals with the same weights as an individual in the population are not inserted,
+ because they would only reduce the diversity of population. It returns whether the individual is inserted.
+ */
+bool insertIndividual(ISLAND *island, const INDIVIDUAL *individual) {
+    vector<INDIVIDUAL> &population = island->population;
+    int i = (int)population.size() - 1;
+    if(!individualLessFunction(*individual, population[i])) return false;
+    for(const INDIVIDUAL &p : population)
+        if(memcmp(p.weight, individual->weight, sizeof(p.weight)) == 0) return false;
+    // Move worse individuals back until the position of individual. Individuals with the same score keep their order.
+    for(; i > 0 && individualLessFunction(*individual, population[i - 1]); i--) population[i] = population[i - 1];
+    population[i] = *individual;
+    return true;
+}
+
+/*
+ Breeds a child from the best individuals of the next unfinished island. (Round robin)
+ It is called in the critical section. It returns false if every island is finished.
+ */
+bool makeChild(const CONFIG *config, int *nextIsland, CHILD *child) {
+    int i;
+    ISLAND *island;
+    FITNESS *cache;
+    for(i = 0; i < config->countOfIsland && isIslandFinished(config, *nextIsland); i++) *nextIsland = (*nextIsland + 1) % config->countOfIsland;
+    if(i == config->countOfIsland) return false;
+    child->island = *nextIsland;
+    *nextIsland = (*nextIsland + 1) % config->countOfIsland;
+    island = &islands[child->island];
+    breedIndividual(island->population.data(), config->countOfTop, &island->rng, &child->individual);
+    memset(&child->cached, 0, sizeof(child->cached));
+    if(config->fitnessCache) {
+        cache = findFitness(island, child->individual.weight);
+        if(cache->countOfGame > 0 && memcmp(cache->weight, child->individual.weight, sizeof(cache->weight)) == 0) child->cached = *cache;
+    }
+    return true;
+}
+
+/*
+ Plays the games of child which are not in the fitness cache. It is called without lock, so threads play children simultaneously.
+ Every child plays the games of the first generation of its island, so children of different generations are compared on the same games.
+ */
+void playChild(const CONFIG *config, const GAME_OPTION *option, CHILD *child, MONITOR *monitor, INDIVIDUAL_STAT *stat) {
+    int j, slot = omp_get_thread_num();
+    ISLAND *island = &islands[child->island];
+    bool shown = monitor != NULL && child->island == 0;
+    RANDOM gameRng;
+    GAME_STAT gameStat;
+    double startTime;
+
+    child->sumOfScore = 0;
+    stat->countOfGame = 0;
+    stat->countOfCachedGame = child->cached.countOfGame;
+    stat->countOfPiece = stat->countOfNode = 0;
+    stat->time = 0;
+    if(config->listenPort > 0 && child->cached.countOfGame < config->countOfPlay) {
+        // Games of child are a job of remote workers.
+        REMOTE_JOB job;
+        vector<int> score(config->countOfPlay - child->cached.countOfGame);
+        vector<GAME_STAT> gameStats(score.size());
+        vector<double> time(score.size());
+        job.weight = child->individual.weight;
+        job.seed = splitSeed(island->seed, 1);
+        job.firstGame = child->cached.countOfGame;
+        job.countOfGame = (int)score.size();
+        job.option = *option;
+        job.score = score.data();
+        job.stat = gameStats.data();
+        job.time = time.data();
+        playRemoteJobs(&job, 1);
+        for(j = 0; j < job.countOfGame; j++) {
+            child->sumOfScore += score[j];
+            stat->countOfGame++;
+            stat->countOfPiece += gameStats[j].countOfPiece;
+            stat->countOfNode += gameStats[j].countOfNode;
+            stat->time += time[j];
+        }
+        return;
+    }
+    for(j = child->cached.countOfGame; j < config->countOfPlay; j++) {
+        initRandom(&gameRng, splitSeed(splitSeed(splitSeed(island->seed, 1), j), 1));
+        startTime = omp_get_wtime();
+        child->sumOfScore += playTetris(child->individual.weight, option, &island->sequence[j], &gameRng,
+                                        shown && monitor->display != NULL && slot < monitor->countOfDisplay ? &monitor->display[slot] : NULL, &gameStat);
+        stat->time += omp_get_wtime() - startTime;
+        stat->countOfGame++;
+        stat->countOfPiece += gameStat.countOfPiece;
+        stat->countOfNode += gameStat.countOfNode;
+        if(shown && monitor->gameFinished != NULL) monitor->gameFinished(monitor->arg, slot, stat->countOfGame);
+    }
+}
+
+/*
+ Adds the evaluated child to its island. It is called in the critical section.
+ When config->countOfPopulation children of island are evaluated, the generation of island is finished.
+ The best individuals of island migrate to the next island every config->migrationInterval generations.
+ Children of finished islands are dropped, so the population is the population at the end of the last generation.
+ */
+void finishChild(const CONFIG *config, CHILD *child, const INDIVIDUAL_STAT *stat, MONITOR *monitor, GENERATION *result, double *startTime) {
+    int i, k = child->island, countOfGame = child->cached.countOfGame + stat->countOfGame;
+    ISLAND *island = &islands[k];
+    FITNESS *cache;
+
+    if(isIslandFinished(config, k)) return;
+    child->individual.score = (child->cached.sumOfScore + child->sumOfScore) / countOfGame;
+    child->individual.piece = (child->cached.sumOfPiece + stat->countOfPiece) / countOfGame;
+    if(config->fitnessCache && stat->countOfGame > 0) {
+        // The entry might be replaced while the child is played, so the sums of the child are written.
+        cache = findFitness(island, child->individual.weight);
+        memcpy(cache->weight, child->individual.weight, sizeof(cache->weight));
+        cache->sumOfScore = child->cached.sumOfScore + child->sumOfScore;
+        cache->sumOfPiece = child->cached.sumOfPiece + stat->countOfPiece;
+        cache->countOfGame = countOfGame;
+    }
+    insertIndividual(island, &child->individual);
+    result->telemetry.individual.push_back(*stat);
+    result->telemetry.score.push_back(child->individual.score);
+    result->telemetry.piece.push_back(child->individual.piece);
+    if(config->listenPort == 0) result->telemetry.busyTime[omp_get_thread_num()] += stat->time;
+    if(++island->countOfChild < config->countOfPopulation) return;
+
+    result->gen = island->gen;
+    result->best = island->population[0];
+    result->averageScore = result->averagePiece = 0;
+    for(i = 0; i < config->countOfPopulation; i++) {
+        result->averageScore += island->population[i].score;
+        result->averagePiece += island->population[i].piece;
+    }
+    result->averageScore /= config->countOfPopulation;
+    result->averagePiece /= config->countOfPopulation;
+    result->telemetry.wallTime = omp_get_wtime() - *startTime;
+    island->gen++;
+    island->countOfChild = 0;
+    if(config->countOfIsland > 1 && result->gen % config->migrationInterval == 0)
+        for(i = 0; i < config->countOfMigrant; i++) insertIndividual(&islands[(k + 1) % config->countOfIsland], &island->population[i]);
+    if(monitor != NULL && monitor->generationFinished != NULL) monitor->generationFinished(monitor->arg, k, result);
+    result->telemetry.individual.clear();
+    result->telemetry.score.clear();
+    result->telemetry.piece.clear();
+    result->telemetry.busyTime.assign(config->threadCount, 0);
+    *startTime = omp_get_wtime();
+}
+
+/*
+ Plays generations of every island until config->maxGeneration in steady state. (Without generation barrier)
+ Population of each island is kept sorted. Each thread breeds a child from the best individuals of the current population,
+ plays its games and replaces the worst individual by the child if the child is better. Then it breeds the next child immediately,
+ so threads never wait for the slowest game of a generation. Only breeding and insertion are done in the critical section.
+ Generation of island is config->countOfPopulation evaluated children. Islands migrate their best individuals without waiting for the others.
+ Individuals stay in the population for many generations, so every individual plays the same games (the games of the first generation)
+ to keep their fitness comparable. The first generation is evaluated together because children are bred from the evaluated population.
+ Racing is used only for the first generation. Results are reported by monitor->generationFinished(), and history is not kept.
+ Results depend on the order of finished children, so they are reproducible only with 1 thread.
+ With remote workers (config->listenPort), each thread waits for the games of its child, so config->threadCount children are played at once.
+ It returns the number of played generations of the first island.
+ */
+int runSteadyState(const CONFIG *config, MONITOR *monitor) {
+    int j, k, nextIsland = 0, previousGen = islands[0].gen;
+    vector<GENERATION> result(config->countOfIsland);      // Generation of each island which is being played.
+    vector<double> startTime(config->countOfIsland);
+    GAME_OPTION option;
+
+    for(k = 0; k < config->countOfIsland && isIslandFinished(config, k); k++);
+    if(k == config->countOfIsland) return 0;
+    initGameOption(config, &option);
+    for(ISLAND &island : islands)
+        for(j = 0; j < config->countOfPlay; j++) resetPieceSequence(&island.sequence[j], splitSeed(splitSeed(splitSeed(island.seed, 1), j), 0));
+
+    #pragma omp parallel num_threads(config->threadCount)
+    #pragma omp single
+    for(k = 0; k < config->countOfIsland; k++) {
+        if(islands[k].gen > 1) continue;
+        #pragma omp task firstprivate(k)
+        {
+            runIsland(config, k, monitor, 1);
+            islands[k].history.clear();
+            islands[k].gen++;
+        }
+    }
+
+    for(k = 0; k < config->countOfIsland; k++) {
+        result[k].telemetry.busyTime.assign(config->threadCount, 0);
+        startTime[k] = omp_get_wtime();
+    }
+    #pragma omp parallel num_threads(config->threadCount)
+    {
+        CHILD child;
+        INDIVIDUAL_STAT stat;
+        bool found;
+        for(;;) {
+            #pragma omp critical (steadyState)
+            found = makeChild(config, &nextIsland, &child);
+            if(!found) break;
+            playChild(config, &option, &child, monitor, &stat);
+            #pragma omp critical (steadyState)
+            finishChild(config, &child, &stat, monitor, &result[child.island], &startTime[child.island]);
+        }
+    }
+    return islands[0].gen - previousGen;
+}
+
+/*
+ Writes the weights of the best individual of generation g of k-th island at the end of file.
+ */
+void writeBestIndividual(const char *fileName, int k, const GENERATION *g) {
+    int i;
+    FILE *outf = fopen(fileName, "a");
+    if(outf == NULL) return;
+    if(islands.size() > 1) fprintf(outf, "Island %d ", k + 1);
+    fprintf(outf, "Gen %d : ", g->gen);
+    for(i = 0; i < NUM_OF_WEIGHTS; i++)
+        fprintf(outf, "%lf ", g->best.weight[i]);
+    fprintf(outf, "\n");
+    fclose(outf);
+}
+
+/*
+ Returns the ratio of time of threads spent on games during the evaluation of generation.
+ */
+double getUtilization(const TELEMETRY *telemetry) {
+    double busyTime = 0;
+    for(double t : telemetry->busyTime) busyTime += t;
+    return telemetry->busyTime.empty() || telemetry->wallTime <= 0 ? 0 : busyTime / (telemetry->wallTime * telemetry->busyTime.size());
+}
+
+/*
+ Writes the telemetry of generation g of k-th island at the end of file as a line of JSON.
+ */
+void writeTelemetry(const char *fileName, int k, const GENERATION *g) {
+    size_t i, t;
+    long long countOfPiece = 0, countOfNode = 0;
+    int countOfGame = 0;
+    const TELEMETRY *telemetry = &g->telemetry;
+    FILE *outf = fopen(fileName, "a");
+    if(outf == NULL) return;
+    for(i = 0; i < telemetry->individual.size(); i++) {
+        countOfPiece += telemetry->individual[i].countOfPiece;
+        countOfNode += telemetry->individual[i].countOfNode;
+        countOfGame += telemetry->individual[i].countOfGame;
+    }
+    fprintf(outf, "{\"island\": %d, \"gen\": %d, \"wallTime\": %.6lf, \"threads\": %d, \"games\": %d, \"pieces\": %lld, \"nodes\": %lld, \"utilization\": %.4lf, \"busyTime\": [",
+            k + 1, g->gen, telemetry->wallTime, (int)telemetry->busyTime.size(), countOfGame, countOfPiece, countOfNode, getUtilization(telemetry));
+    for(t = 0; t < telemetry->busyTime.size(); t++)
+        fprintf(outf, "%s%.6lf", t > 0 ? ", " : "", telemetry->busyTime[t]);
+    fprintf(outf, "], \"individuals\": [");
+    for(i = 0; i < telemetry->individual.size(); i++) {
+        const INDIVIDUAL_STAT *stat = &telemetry->individual[i];
+        fprintf(outf, "%s{\"pop\": %d, \"score\": %.2lf, \"games\": %d, \"cachedGames\": %d, \"pieces\": %lld, \"nodes\": %lld, \"averagePiece\": %.1lf, \"time\": %.6lf}",
+                i > 0 ? ", " : "", (int)i + 1, telemetry->score[i], stat->countOfGame, stat->countOfCachedGame, stat->countOfPiece, stat->countOfNode, stat->countOfGame > 0 ? stat->countOfPiece / (double)stat->countOfGame : 0, stat->time);
+    }
+    fprintf(outf, "]}\n");
+    fclose(outf);
+}
+
+/*
+ Makes a child by mixing weights of parents. (Crossover)
+ Also mutation will occured by 10% chance and weight will be modified in range of -0.5 ~ 0.5. (Mutation)
+ */
+void breedIndividual(const INDIVIDUAL *parent, int countOfParent, RANDOM *rng, INDIVIDUAL *child) {
+    int j;
+    for(j = 0; j < NUM_OF_WEIGHTS; j++) {
+        child->weight[j] = parent[randomInt(rng, countOfParent)].weight[j];
+        // Mutation: Mutate the weights in -0.5 ~ 0.5 by 10% chance.
+        if(randomInt(rng, 100) < CHANCE_OF_MUTATION) {
+            if(randomInt(rng, 2) == 0) child->weight[j] += randomDouble(rng) * AMOUNT_OF_MUTATION;
+            else child->weight[j] -= randomDouble(rng) * AMOUNT_OF_MUTATION;
+        }
+    }
+    child->score = 0;
+    child->dropped = false;
+}
+
+/*
+ Generates the next generation of island from sorted population.
+ To generate next generation, top 4 (config->countOfTop) individuals will be chosen which show good performance. (Selection)
+ And 20 (config->countOfPopulation) individuals of next generation will be generated by mixing weights of them. (Crossover)
+ */
+void breedPopulation(const CONFIG *config, ISLAND *island) {
+    // Selection: Select top 4 individuals.
+    vector<INDIVIDUAL> good(island->population.begin(), island->population.begin() + config->countOfTop);
+    // Crossover: Mix weights of top 4 individuals to make new generation.
+    for(INDIVIDUAL &individual : island->population)
+        breedIndividual(good.data(), config->countOfTop, &island->rng, &individual);
+    island->gen++;
+}
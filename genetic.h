@@ -0,0 +1,177 @@
+#ifndef genetic_h
+#define genetic_h
+
+#include <vector>
+#include "tetris.h"
+
+#define NUM_OF_POPULATION 20            // Default # of individuals of each island.
+#define NUM_OF_TOP_POPULATION 4         // Default # of best individuals selected for crossover.
+#define NUM_OF_PLAY 20                  // Default # of games of each individual.
+#define MIGRATION_INTERVAL 5            // Default # of generations between migrations of islands.
+#define NUM_OF_MIGRANT 1                // Default # of best individuals sent to the next island at migration.
+
+#define CHANCE_OF_MUTATION 10
+#define AMOUNT_OF_MUTATION 0.5
+
+#define SIZE_OF_FITNESS_CACHE 1024       // # of entries of fitness cache.
+#define RACING_CONFIDENCE 2.0           // Individual is dropped if it is worse than others by this many standard errors.
+
+#define CHECKPOINT_MAGIC 0x4b434754     // "TGCK"
+#define CHECKPOINT_VERSION 9
+
+/*
+ Structure of individual of genetic algorithm.
+ Each individual stores the weights of factors.
+ */
+typedef struct _INDIVIDUAL {
+    double weight[NUM_OF_WEIGHTS];
+    /*
+     Weights of factors (properties)
+     [0]: Sum of heights of each column of field
+     [1]: # of Holes
+     [2]: # of Blockades
+     [3]: Gotten score by reaching block to the floor
+     [4]: Gotten score by removing lines
+     [5]: # of blocks reached at wall
+     [6]: SD(Standard deviation) of heights of field
+     [7]: Difference between max height and min height of field
+     */
+    double score;           // Score of each individual. (Fitness of each individual)
+    double piece;           // Average # of blocks of games of each individual.
+    bool dropped;           // Whether individual is dropped by racing before playing every game. Its score is the average of played games.
+} INDIVIDUAL;
+
+/*
+ Entry of fitness cache. It stores the sums of all games played by the individual with the weights in all generations.
+ */
+typedef struct _FITNESS {
+    double weight[NUM_OF_WEIGHTS];
+    double sumOfScore;
+    double sumOfPiece;
+    int countOfGame;        // # of played games. (0: empty entry)
+} FITNESS;
+
+/*
+ Options of machine learning. They are set by command line options.
+ */
+typedef struct _CONFIG {
+    int threadCount;                // # of threads.
+    uint64_t seed;                  // Seed of the whole run. Every generator is derived from this.
+    int maxGeneration;              // # of generations to learn. (0: unlimited)
+    int countOfPopulation;          // # of individuals of each island.
+    int countOfTop;                 // # of best individuals of each island selected for crossover.
+    int countOfIsland;              // # of islands. Each island evolves its own population.
+    int migrationInterval;          // # of generations between migrations of islands.
+    int countOfMigrant;             // # of best individuals sent to the next island at migration.
+    int countOfPlay;                // # of games of each individual.
+    int raceRound;                  // # of games of each round of racing. (0: every individual plays every game)
+    bool steadyState;               // Replace individuals one by one as soon as they are evaluated instead of generation by generation.
+    bool fitnessCache;              // Reuse the games of individuals with the same weights in previous generations.
+    int maxPiece;                   // Maximum # of blocks of each game. (0: unlimited)
+    long long pieceBudget;          // Maximum # of blocks of each generation. (0: unlimited)
+    int width, height;              // Size of board of games. (One of FOR_EACH_BOARD)
+    int depth;                      // # of blocks to look ahead.
+    int beamWidth;                  // # of best plays of each level to look ahead. (0: all plays)
+    bool simd;                      // Use SIMD instructions to score plays if CPU supports them.
+    const char *logFile;            // File of telemetry log. (NULL: no log)
+    int checkpointInterval;         // # of generations between checkpoints. (0: no checkpoint)
+    const char *checkpointFile;     // File of checkpoint.
+    const char *resumeFile;         // File of checkpoint to resume from. (NULL: start from the first generation)
+    int listenPort;                 // TCP port of coordinator. Games are played by remote workers. (0: games are played by threads)
+} CONFIG;
+
+/*
+ Telemetry of each individual of current generation. (Sum of its games)
+ */
+typedef struct _INDIVIDUAL_STAT {
+    int countOfGame;                // # of played games.
+    int countOfCachedGame;          // # of games reused from fitness cache or the same individual of this generation.
+    long long countOfPiece;         // # of stacked blocks.
+    long long countOfNode;          // # of nodes expanded by the search.
+    double time;                    // Sum of seconds of games.
+} INDIVIDUAL_STAT;
+
+/*
+ Telemetry of a generation of island. It is filled by evaluatePopulation().
+ Individuals are in the order of evaluation, which is the order before sortPopulation().
+ If there are several islands, threads also play games of the other islands, so busy time counts only games of this island.
+ */
+typedef struct _TELEMETRY {
+    double wallTime;                                // Seconds of evaluation.
+    std::vector<double> busyTime;                   // Seconds of games of this island played by each thread.
+    std::vector<INDIVIDUAL_STAT> individual;
+    std::vector<double> score;                      // Fitness of each individual.
+    std::vector<double> piece;                      // Average # of blocks of games of each individual.
+} TELEMETRY;
+
+/*
+ Result of a generation of island.
+ */
+typedef struct _GENERATION {
+    int gen;                                        // # of generation
+    INDIVIDUAL best;                                // The best individual of generation.
+    double averageScore;                            // Average fitness of individuals.
+    double averagePiece;                            // Average # of blocks of games of individuals.
+    TELEMETRY telemetry;
+} GENERATION;
+
+/*
+ Island of genetic algorithm. Each island has its own population, and selection and crossover are done in the island.
+ Islands evolve independently and send their best individuals to the next island every config->migrationInterval generations.
+ */
+typedef struct _ISLAND {
+    std::vector<INDIVIDUAL> population;             // Individuals of current generation. The best config->countOfTop are selected.
+    int gen;                                        // # of generation
+    uint64_t seed;                                  // Seed of games of island.
+    RANDOM rng;                                     // Generator for crossover and mutation.
+    PIECE_SEQUENCE *sequence;                       // Blocks of each game of current generation. Every individual plays the same games.
+    int countOfSequence;                            // # of games of sequence.
+    std::vector<FITNESS> fitnessCache;              // Fitness of recent weights. Entries are replaced when other weights have the same slot.
+    std::vector<GENERATION> history;                // Generations finished by the last runGenerations(). (Not kept in steady state)
+    int countOfChild;                               // # of evaluated children of current generation. (Steady state)
+} ISLAND;
+
+/*
+ Callbacks to show the progress of generation. Only individuals of the first island are shown.
+ gameFinished() is called whenever a game of individual(pop) is finished. It can be NULL.
+ In steady state, pop is the thread which plays the game, because individuals are not evaluated together.
+ generationFinished() is called whenever a generation of island is finished. Calls are not simultaneous. It can be NULL.
+ display is the array of displays of the first countOfDisplay individuals (threads in steady state). If it is NULL, games are not drawn.
+ */
+typedef struct _MONITOR {
+    void (*gameFinished)(void *arg, int pop, int countOfFinishedGame);
+    void (*generationFinished)(void *arg, int island, const GENERATION *g);
+    DISPLAY *display;
+    int countOfDisplay;
+    void *arg;
+} MONITOR;
+
+extern std::vector<ISLAND> islands;
+
+void initConfig(CONFIG *config);
+bool parseBoard(CONFIG *config, const char *value);
+bool parseConfig(CONFIG *config, int argc, char *argv[], int *i);
+void checkConfig(CONFIG *config);
+void initIslands(const CONFIG *config);
+void freeIslands();
+void initPopulation(ISLAND *island);
+bool initTraining(CONFIG *config);
+bool writeCheckpoint(const char *fileName, const CONFIG *config);
+bool readCheckpoint(const char *fileName, CONFIG *config);
+bool saveCheckpoint(const CONFIG *config, int previousGen);
+int runGenerations(const CONFIG *config, MONITOR *monitor);
+FITNESS *findFitness(ISLAND *island, const double *weight);
+void initGameOption(const CONFIG *config, GAME_OPTION *option);
+void evaluatePopulation(const CONFIG *config, ISLAND *island, MONITOR *monitor, TELEMETRY *telemetry);
+void sortPopulation(ISLAND *island);
+void runIsland(const CONFIG *config, int k, MONITOR *monitor, int count);
+void migrateIslands(const CONFIG *config);
+int runSteadyState(const CONFIG *config, MONITOR *monitor);
+bool insertIndividual(ISLAND *island, const INDIVIDUAL *individual);
+void breedIndividual(const INDIVIDUAL *parent, int countOfParent, RANDOM *rng, INDIVIDUAL *child);
+void breedPopulation(const CONFIG *config, ISLAND *island);
+void writeBestIndividual(const char *fileName, int k, const GENERATION *g);
+double getUtilization(const TELEMETRY *telemetry);
+void writeTelemetry(const char *fileName, int k, const GENERATION *g);
+
+#endif
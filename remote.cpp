@@ -0,0 +1,569 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <omp.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "remote.h"
+
+using namespace std;
+
+#define MESSAGE_HELLO 1
+#define MESSAGE_JOB 2
+#define MESSAGE_RESULT 3
+#define MESSAGE_HEARTBEAT 4
+
+#define MAX_MESSAGE_SIZE (1 << 24)      // Messages larger than this are wrong.
+
+/*
+ Protocol between coordinator and workers. Each message is a header followed by size bytes of body.
+ Worker sends HELLO once, and then coordinator sends JOBs and worker sends a RESULT for each job whenever its games are finished.
+ Worker also sends HEARTBEAT (without body) every REMOTE_HEARTBEAT_INTERVAL seconds, because games can be longer than REMOTE_TIMEOUT.
+ Numbers are sent in the byte order of machines, so coordinator and workers should run on the same kind of machines.
+ */
+typedef struct _MESSAGE_HEADER {
+    uint32_t type;
+    uint32_t size;
+} MESSAGE_HEADER;
+
+typedef struct _HELLO_MESSAGE {
+    uint32_t version;               // REMOTE_VERSION
+    int32_t countOfWeight;          // NUM_OF_WEIGHTS
+    int32_t threadCount;            // # of threads of worker which play games.
+} HELLO_MESSAGE;
+
+typedef struct _JOB_MESSAGE {
+    uint32_t id;
+    int32_t firstGame;
+    int32_t countOfGame;
+    int32_t width;
+    int32_t height;
+    int32_t depth;
+    int32_t beamWidth;
+    int32_t limitOfPiece;
+    uint64_t seed;
+    double weight[NUM_OF_WEIGHTS];
+} JOB_MESSAGE;
+
+/*
+ RESULT message is the id and the number of games of job followed by the result of each game.
+ */
+typedef struct _RESULT_MESSAGE {
+    uint32_t id;
+    int32_t countOfGame;
+} RESULT_MESSAGE;
+
+typedef struct _GAME_RESULT {
+    int64_t countOfPiece;
+    int64_t countOfNode;
+    double time;
+    int32_t score;
+    int32_t reserved;
+} GAME_RESULT;
+
+/*
+ Job which is waiting for a worker or being played by a worker.
+ */
+typedef struct _PENDING_JOB {
+    REMOTE_JOB *job;
+    int *remaining;                 // # of unfinished jobs of the call of playRemoteJobs().
+} PENDING_JOB;
+
+/*
+ Connection of worker. It is used only by the coordinator thread. Socket is non-blocking, so a worker never stalls the coordinator.
+ */
+typedef struct _WORKER {
+    int socket;
+    string name;
+    int threadCount;                // 0 until HELLO is received.
+    int countOfGame;                // # of games being played.
+    vector<uint32_t> job;           // Jobs being played.
+    string input;                   // Received bytes which are not a whole message yet.
+    double lastReceived;            // Time when anything is received from worker last.
+} WORKER;
+
+/*
+ State of coordinator. Jobs are shared by the threads of learning and the coordinator thread, so they are protected by lock.
+ */
+typedef struct _COORDINATOR {
+    int listenSocket;
+    int wakePipe[2];                        // Wakes the coordinator thread when jobs are added or it is stopped.
+    thread loop;
+    mutex lock;
+    condition_variable finished;            // Notified whenever jobs are finished.
+    deque<uint32_t> waiting;                // Jobs waiting for a worker.
+    map<uint32_t, PENDING_JOB> job;         // Jobs which are waiting or being played.
+    uint32_t nextId;
+    bool stop;
+} COORDINATOR;
+
+/*
+ Job being played by worker. Its games are played by different threads, and the last finished game sends the result.
+ */
+typedef struct _WORKER_JOB {
+    JOB_MESSAGE message;
+    vector<GAME_RESULT> result;
+    atomic<int> remaining;
+} WORKER_JOB;
+
+COORDINATOR *coordinator = NULL;
+
+/*
+ Reads or writes the whole buffer. They return false if the connection is lost.
+ Sockets of workers on the coordinator are non-blocking, so writing waits until the worker receives, up to REMOTE_TIMEOUT seconds.
+ */
+bool readFully(int socket, void *buffer, size_t size) {
+    char *p = (char*)buffer;
+    ssize_t n;
+    while(size > 0) {
+        n = read(socket, p, size);
+        if(n < 0 && errno == EINTR) continue;
+        if(n <= 0) return false;
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+bool writeFully(int socket, const void *buffer, size_t size) {
+    const char *p = (const char*)buffer;
+    ssize_t n;
+    while(size > 0) {
+        n = write(socket, p, size);
+        if(n < 0 && errno == EINTR) continue;
+        if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            pollfd fd = {socket, POLLOUT, 0};
+            if(poll(&fd, 1, REMOTE_TIMEOUT * 1000) > 0) continue;
+            return false;
+        }
+        if(n <= 0) return false;
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+bool writeMessage(int socket, uint32_t type, const void *body, size_t size) {
+    MESSAGE_HEADER header = {type, (uint32_t)size};
+    return writeFully(socket, &header, sizeof(header)) && writeFully(socket, body, size);
+}
+
+/*
+ Messages are small and sent one by one, so they are sent immediately.
+ */
+void setNoDelay(int socket) {
+    int one = 1;
+    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+/*
+ Closes the connection of lost worker, and gives its jobs back to the waiting jobs, so they are played by the other workers.
+ */
+void loseWorker(vector<WORKER> &worker, size_t w) {
+    size_t i, count = 0;
+    {
+        lock_guard<mutex> lock(coordinator->lock);
+        for(i = worker[w].job.size(); i-- > 0;) {
+            if(coordinator->job.count(worker[w].job[i]) == 0) continue;
+            coordinator->waiting.push_front(worker[w].job[i]);
+            count++;
+        }
+    }
+    fprintf(stderr, "Worker %s is lost. %d jobs are resubmitted.\n", worker[w].name.c_str(), (int)count);
+    close(worker[w].socket);
+    worker.erase(worker.begin() + w);
+}
+
+/*
+ Handles a whole message of worker. Body is in the input buffer of worker, so it is copied to aligned structures.
+ It returns false if the message is wrong.
+ */
+bool handleWorkerMessage(WORKER *worker, const MESSAGE_HEADER *header, const char *body) {
+    HELLO_MESSAGE hello;
+    RESULT_MESSAGE result;
+    GAME_RESULT game;
+    int i, j;
+
+    if(header->type == MESSAGE_HEARTBEAT && header->size == 0) return true;
+    if(header->type == MESSAGE_HELLO && header->size == sizeof(hello) && worker->threadCount == 0) {
+        memcpy(&hello, body, sizeof(hello));
+        if(hello.version != REMOTE_VERSION || hello.countOfWeight != NUM_OF_WEIGHTS) return false;
+        worker->threadCount = max(1, (int)hello.threadCount);
+        fprintf(stderr, "Worker %s is connected. (%d threads)\n", worker->name.c_str(), worker->threadCount);
+        return true;
+    }
+    if(header->type != MESSAGE_RESULT || header->size < sizeof(result)) return false;
+    memcpy(&result, body, sizeof(result));
+    if(result.countOfGame < 0 || header->size != sizeof(result) + result.countOfGame * sizeof(GAME_RESULT)) return false;
+    // Result is checked before the job is removed from the worker, so a wrong result loses the worker with the job, and the job is resubmitted.
+    for(i = 0; i < (int)worker->job.size() && worker->job[i] != result.id; i++);
+    if(i == (int)worker->job.size()) return false;
+    {
+        lock_guard<mutex> lock(coordinator->lock);
+        map<uint32_t, PENDING_JOB>::iterator pending = coordinator->job.find(result.id);
+        if(pending == coordinator->job.end() || pending->second.job->countOfGame != result.countOfGame) return false;
+        REMOTE_JOB *job = pending->second.job;
+        for(j = 0; j < result.countOfGame; j++) {
+            memcpy(&game, body + sizeof(result) + j * sizeof(GAME_RESULT), sizeof(game));
+            job->score[j] = game.score;
+            job->stat[j].countOfPiece = (int)game.countOfPiece;
+            job->stat[j].countOfNode = game.countOfNode;
+            job->time[j] = game.time;
+        }
+        if(--*pending->second.remaining == 0) coordinator->finished.notify_all();
+        coordinator->job.erase(pending);
+    }
+    worker->job.erase(worker->job.begin() + i);
+    worker->countOfGame -= result.countOfGame;
+    return true;
+}
+
+/*
+ Reads received bytes of worker without blocking and handles every whole message of them. The rest of a message is kept until it is received.
+ It returns false if the connection is lost or a message is wrong.
+ */
+bool receiveWorker(WORKER *worker) {
+    char buffer[65536];
+    MESSAGE_HEADER header;
+    size_t offset = 0;
+    ssize_t n;
+
+    for(;;) {
+        n = read(worker->socket, buffer, sizeof(buffer));
+        if(n < 0 && errno == EINTR) continue;
+        if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if(n <= 0) return false;
+        worker->input.append(buffer, n);
+    }
+    worker->lastReceived = omp_get_wtime();
+    while(worker->input.size() - offset >= sizeof(header)) {
+        memcpy(&header, worker->input.data() + offset, sizeof(header));
+        if(header.size > MAX_MESSAGE_SIZE) return false;
+        if(worker->input.size() - offset < sizeof(header) + header.size) break;
+        if(!handleWorkerMessage(worker, &header, worker->input.data() + offset + sizeof(header))) return false;
+        offset += sizeof(header) + header.size;
+    }
+    worker->input.erase(0, offset);
+    return true;
+}
+
+/*
+ Sends waiting jobs to workers until each thread of each worker has REMOTE_GAME_PER_THREAD games.
+ */
+void sendJobs(vector<WORKER> &worker) {
+    size_t w;
+    JOB_MESSAGE message;
+    REMOTE_JOB *job;
+    bool found;
+    for(w = 0; w < worker.size(); w++) {
+        while(worker[w].threadCount > 0 && worker[w].countOfGame < worker[w].threadCount * REMOTE_GAME_PER_THREAD) {
+            {
+                lock_guard<mutex> lock(coordinator->lock);
+                found = !coordinator->waiting.empty();
+                if(found) {
+                    message.id = coordinator->waiting.front();
+                    coordinator->waiting.pop_front();
+                    job = coordinator->job[message.id].job;
+                    message.firstGame = job->firstGame;
+                    message.countOfGame = job->countOfGame;
+                    message.width = job->option.width;
+                    message.height = job->option.height;
+                    message.depth = job->option.depth;
+                    message.beamWidth = job->option.beamWidth;
+                    message.limitOfPiece = job->option.limitOfPiece;
+                    message.seed = job->seed;
+                    memcpy(message.weight, job->weight, sizeof(message.weight));
+                }
+            }
+            if(!found) return;
+            worker[w].job.push_back(message.id);
+            worker[w].countOfGame += message.countOfGame;
+            if(!writeMessage(worker[w].socket, MESSAGE_JOB, &message, sizeof(message))) {
+                loseWorker(worker, w--);
+                break;
+            }
+        }
+    }
+}
+
+/*
+ Coordinator thread. It accepts workers, sends waiting jobs to workers and receives their results until it is stopped.
+ Workers which send nothing for REMOTE_TIMEOUT seconds (not even heartbeats) are hung or cut off, so they are lost and their jobs are resubmitted.
+ */
+void runCoordinator() {
+    vector<WORKER> worker;
+    vector<pollfd> fds;
+    size_t w;
+    double now;
+    char buffer[64];
+    sockaddr_storage address;
+    socklen_t addressLength;
+    WORKER newWorker;
+
+    for(;;) {
+        {
+            lock_guard<mutex> lock(coordinator->lock);
+            if(coordinator->stop) break;
+        }
+        sendJobs(worker);
+        fds.assign(2 + worker.size(), pollfd());
+        fds[0].fd = coordinator->wakePipe[0];
+        fds[1].fd = coordinator->listenSocket;
+        for(w = 0; w < worker.size(); w++) fds[2 + w].fd = worker[w].socket;
+        for(pollfd &fd : fds) fd.events = POLLIN;
+        if(poll(fds.data(), fds.size(), REMOTE_HEARTBEAT_INTERVAL * 1000) < 0) continue;
+        if(fds[0].revents != 0) while(read(coordinator->wakePipe[0], buffer, sizeof(buffer)) > 0);
+        // Workers are checked backward, so lost workers can be removed.
+        for(w = worker.size(); w-- > 0;)
+            if(fds[2 + w].revents != 0 && !receiveWorker(&worker[w])) loseWorker(worker, w);
+        now = omp_get_wtime();
+        for(w = worker.size(); w-- > 0;) {
+            if(now - worker[w].lastReceived <= REMOTE_TIMEOUT) continue;
+            fprintf(stderr, "Worker %s doesn't respond for %d seconds.\n", worker[w].name.c_str(), REMOTE_TIMEOUT);
+            loseWorker(worker, w);
+        }
+        if(fds[1].revents != 0) {
+            addressLength = sizeof(address);
+            newWorker.socket = accept(coordinator->listenSocket, (sockaddr*)&address, &addressLength);
+            if(newWorker.socket < 0) continue;
+            setNoDelay(newWorker.socket);
+            fcntl(newWorker.socket, F_SETFL, O_NONBLOCK);
+            if(getnameinfo((sockaddr*)&address, addressLength, buffer, sizeof(buffer), NULL, 0, NI_NUMERICHOST) != 0) strcpy(buffer, "?");
+            newWorker.name = buffer;
+            newWorker.threadCount = newWorker.countOfGame = 0;
+            newWorker.job.clear();
+            newWorker.input.clear();
+            newWorker.lastReceived = omp_get_wtime();
+            worker.push_back(newWorker);
+        }
+    }
+    for(WORKER &wk : worker) close(wk.socket);
+}
+
+/*
+ Starts the coordinator which accepts workers on the TCP port. Games are played by the workers instead of threads of this process.
+ It returns false if the port can't be listened.
+ */
+bool startCoordinator(int port) {
+    int one = 1;
+    sockaddr_in address;
+
+    signal(SIGPIPE, SIG_IGN);
+    coordinator = new COORDINATOR();
+    coordinator->listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if(coordinator->listenSocket < 0
+       || setsockopt(coordinator->listenSocket, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) != 0
+       || bind(coordinator->listenSocket, (sockaddr*)&address, sizeof(address)) != 0
+       || listen(coordinator->listenSocket, 64) != 0
+       || pipe(coordinator->wakePipe) != 0) {
+        if(coordinator->listenSocket >= 0) close(coordinator->listenSocket);
+        delete coordinator;
+        coordinator = NULL;
+        return false;
+    }
+    fcntl(coordinator->wakePipe[0], F_SETFL, O_NONBLOCK);
+    fcntl(coordinator->wakePipe[1], F_SETFL, O_NONBLOCK);
+    coordinator->nextId = 0;
+    coordinator->stop = false;
+    coordinator->loop = thread(runCoordinator);
+    return true;
+}
+
+/*
+ Wakes the coordinator thread. If the pipe is full, it is already woken.
+ */
+void wakeCoordinator() {
+    char c = 0;
+    if(write(coordinator->wakePipe[1], &c, 1) < 0 && errno != EAGAIN) perror("wakeCoordinator");
+}
+
+/*
+ Stops the coordinator. Workers are disconnected, so they exit.
+ */
+void stopCoordinator() {
+    if(coordinator == NULL) return;
+    {
+        lock_guard<mutex> lock(coordinator->lock);
+        coordinator->stop = true;
+    }
+    wakeCoordinator();
+    coordinator->loop.join();
+    close(coordinator->listenSocket);
+    close(coordinator->wakePipe[0]);
+    close(coordinator->wakePipe[1]);
+    delete coordinator;
+    coordinator = NULL;
+}
+
+/*
+ Plays the jobs by remote workers and waits until every job is finished. It can be called by several threads simultaneously.
+ If a worker is lost, its jobs are played again by the other workers. If no worker is connected, it waits for workers.
+ */
+void playRemoteJobs(REMOTE_JOB *job, int count) {
+    int i, remaining = count;
+    PENDING_JOB pending;
+    unique_lock<mutex> lock(coordinator->lock);
+    pending.remaining = &remaining;
+    for(i = 0; i < count; i++) {
+        pending.job = &job[i];
+        coordinator->job[coordinator->nextId] = pending;
+        coordinator->waiting.push_back(coordinator->nextId++);
+    }
+    wakeCoordinator();
+    coordinator->finished.wait(lock, [&remaining] { return remaining == 0; });
+}
+
+/*
+ Connects to the coordinator of address (host:port). It returns the socket or -1.
+ */
+int connectCoordinator(const char *address) {
+    string host = address, port;
+    addrinfo hint, *result, *p;
+    int s = -1;
+    size_t colon = host.rfind(':');
+    if(colon == string::npos) return -1;
+    port = host.substr(colon + 1);
+    host = host.substr(0, colon);
+    memset(&hint, 0, sizeof(hint));
+    hint.ai_family = AF_UNSPEC;
+    hint.ai_socktype = SOCK_STREAM;
+    if(getaddrinfo(host.c_str(), port.c_str(), &hint, &result) != 0) return -1;
+    for(p = result; p != NULL; p = p->ai_next) {
+        s = socket(p->ai_family, p->ai_socktype, p->ai_protocol);
+        if(s < 0) continue;
+        if(connect(s, p->ai_addr, p->ai_addrlen) == 0) break;
+        close(s);
+        s = -1;
+    }
+    freeaddrinfo(result);
+    if(s >= 0) setNoDelay(s);
+    return s;
+}
+
+/*
+ Checks the options of job received from the coordinator. Games with options out of range can't be played by the engine,
+ and the result of more games than MAX_MESSAGE_SIZE can't be sent.
+ */
+bool checkJob(const JOB_MESSAGE *message) {
+    return message->countOfGame > 0 && message->countOfGame <= (int)((MAX_MESSAGE_SIZE - sizeof(RESULT_MESSAGE)) / sizeof(GAME_RESULT)) && checkBoard(message->width, message->height)
+        && message->depth >= 1 && message->depth <= MAX_BLOCK_NUM && message->beamWidth >= 0 && message->limitOfPiece >= 0;
+}
+
+/*
+ Plays k-th game of job. The game is the same as the game played by the coordinator with the same seed.
+ */
+void playJobGame(WORKER_JOB *job, int k) {
+    const JOB_MESSAGE *message = &job->message;
+    uint64_t seed = splitSeed(message->seed, message->firstGame + k);
+    GAME_OPTION option;
+    PIECE_SEQUENCE *sequence = new PIECE_SEQUENCE;
+    RANDOM rng;
+    GAME_STAT stat;
+    double startTime = omp_get_wtime();
+
+    option.width = message->width;
+    option.height = message->height;
+    option.depth = message->depth;
+    option.beamWidth = message->beamWidth;
+    option.limitOfPiece = message->limitOfPiece;
+    initPieceSequence(sequence);
+    resetPieceSequence(sequence, splitSeed(seed, 0));
+    initRandom(&rng, splitSeed(seed, 1));
+    job->result[k].score = playTetris(message->weight, &option, sequence, &rng, NULL, &stat);
+    job->result[k].countOfPiece = stat.countOfPiece;
+    job->result[k].countOfNode = stat.countOfNode;
+    job->result[k].time = omp_get_wtime() - startTime;
+    job->result[k].reserved = 0;
+    freePieceSequence(sequence);
+    delete sequence;
+}
+
+/*
+ Sends the result of finished job. Results of different jobs are sent by different threads, so sending is locked.
+ */
+void sendJobResult(int socket, mutex *sendLock, const WORKER_JOB *job) {
+    RESULT_MESSAGE result = {job->message.id, job->message.countOfGame};
+    MESSAGE_HEADER header = {MESSAGE_RESULT, (uint32_t)(sizeof(result) + job->result.size() * sizeof(GAME_RESULT))};
+    lock_guard<mutex> lock(*sendLock);
+    // If the coordinator is lost, the result is dropped and the worker stops after the next read.
+    if(writeFully(socket, &header, sizeof(header)) && writeFully(socket, &result, sizeof(result))) writeFully(socket, job->result.data(), job->result.size() * sizeof(GAME_RESULT));
+}
+
+/*
+ Runs as a worker of the coordinator of address (host:port). It waits for the coordinator if it isn't started yet.
+ Each game of each job is a task, so threadCount threads play games of several jobs while one more thread receives jobs and sends heartbeats.
+ It returns when the coordinator closes the connection.
+ */
+int runWorker(const char *address, int threadCount) {
+    int s, j;
+    double nextHeartbeat;
+    mutex sendLock;
+    HELLO_MESSAGE hello = {REMOTE_VERSION, NUM_OF_WEIGHTS, threadCount};
+
+    signal(SIGPIPE, SIG_IGN);
+    while((s = connectCoordinator(address)) < 0) sleep(1);
+    if(!writeMessage(s, MESSAGE_HELLO, &hello, sizeof(hello))) {
+        close(s);
+        return 1;
+    }
+    fprintf(stderr, "Connected to coordinator %s. (%d threads)\n", address, threadCount);
+    nextHeartbeat = omp_get_wtime() + REMOTE_HEARTBEAT_INTERVAL;
+
+    #pragma omp parallel num_threads(threadCount + 1)
+    #pragma omp single
+    for(;;) {
+        MESSAGE_HEADER header;
+        WORKER_JOB *job;
+        pollfd fd = {s, POLLIN, 0};
+        if(omp_get_wtime() >= nextHeartbeat) {
+            // If the coordinator is lost, the heartbeat is dropped and the worker stops after the next read.
+            {
+                lock_guard<mutex> lock(sendLock);
+                writeMessage(s, MESSAGE_HEARTBEAT, NULL, 0);
+            }
+            nextHeartbeat = omp_get_wtime() + REMOTE_HEARTBEAT_INTERVAL;
+        }
+        if(poll(&fd, 1, max(0, (int)((nextHeartbeat - omp_get_wtime()) * 1000)) + 1) <= 0) continue;
+        job = new WORKER_JOB;
+        if(!readFully(s, &header, sizeof(header)) || header.type != MESSAGE_JOB || header.size != sizeof(JOB_MESSAGE)
+           || !readFully(s, &job->message, sizeof(job->message)) || !checkJob(&job->message)) {
+            delete job;
+            break;
+        }
+        job->result.resize(job->message.countOfGame);
+        job->remaining = job->message.countOfGame;
+        for(j = 0; j < job->message.countOfGame; j++) {
+            #pragma omp task firstprivate(job, j) shared(s, sendLock)
+            {
+                playJobGame(job, j);
+                if(--job->remaining == 0) {
+                    sendJobResult(s, &sendLock, job);
+                    delete job;
+                }
+            }
+        }
+    }
+    close(s);
+    fprintf(stderr, "Coordinator %s is disconnected.\n", address);
+    return 0;
+}
@@ -0,0 +1,32 @@
+#ifndef remote_h
+#define remote_h
+
+#include "tetris.h"
+
+#define REMOTE_VERSION 3
+#define REMOTE_GAME_PER_THREAD 2        // # of games sent to each thread of worker in advance, so workers don't wait for the next job.
+#define REMOTE_HEARTBEAT_INTERVAL 5     // Seconds between heartbeats of worker.
+#define REMOTE_TIMEOUT 30               // Worker is lost if nothing is received from it for this many seconds.
+
+/*
+ Games of an individual played by a remote worker.
+ Blocks of game j are splitSeed(splitSeed(seed, j), 0) and generator of game j is splitSeed(splitSeed(seed, j), 1),
+ so the games are exactly the same as the games played by the coordinator.
+ */
+typedef struct _REMOTE_JOB {
+    const double *weight;           // Weights of individual.
+    uint64_t seed;                  // Seed of games.
+    int firstGame;                  // Index of the first game.
+    int countOfGame;                // # of games.
+    GAME_OPTION option;
+    int *score;                     // Score of each game. ([game - firstGame])
+    GAME_STAT *stat;                // Statistics of each game.
+    double *time;                   // Seconds of each game on worker.
+} REMOTE_JOB;
+
+bool startCoordinator(int port);
+void stopCoordinator();
+void playRemoteJobs(REMOTE_JOB *job, int count);
+int runWorker(const char *address, int threadCount);
+
+#endif
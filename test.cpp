@@ -0,0 +1,209 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "genetic.h"
+#include "tetris.h"
+
+using namespace std;
+
+#define NUM_OF_TEST_GAME 2000   // # of random games on each board.
+#define NUM_OF_TEST_MOVE 200    // # of random placements of each game. Most games reach the top, so blocks are also clipped there.
+
+#define CACHED_SCORE 1e6        // Mean score of the weights which are in fitness cache before the evaluation.
+
+#define NUM_OF_ALLOCATION_GAME 5        // # of games on each board after the warm-up game.
+#define LIMIT_OF_ALLOCATION_PIECE 500   // Maximum # of blocks of each game.
+
+long long countOfMove = 0, countOfMismatch = 0;
+
+/*
+ Checks the properties of field(f) which are updated incrementally against a full scan of its lines.
+ It prints the first mismatches and returns false if any property is different.
+ */
+template<int W, int H> bool checkField(const Field<W, H> *f, int game, int move) {
+    int i, j, top, holes, sumOfHeight = 0, sumOfSquareOfHeight = 0, countOfHoles = 0, countOfBlockades = 0, maxHeight = 0;
+    bool same = true;
+    for(j = 0; j < W; j++) {
+        for(top = 0; top < H && ((f->line[top] >> j) & 1) == 0; top++);
+        for(i = top, holes = 0; i < H; i++) holes += ((f->line[i] >> j) & 1) == 0;
+        if(f->height[j] != H - top || f->holes[j] != holes) same = false;
+        sumOfHeight += H - top;
+        sumOfSquareOfHeight += (H - top) * (H - top);
+        countOfHoles += holes;
+        if(holes > 0) countOfBlockades += H - top - holes;
+        if(H - top > maxHeight) maxHeight = H - top;
+    }
+    if(f->sumOfHeight != sumOfHeight || f->sumOfSquareOfHeight != sumOfSquareOfHeight || f->countOfHoles != countOfHoles
+       || f->countOfBlockades != countOfBlockades || f->maxHeight != maxHeight) same = false;
+    if(!same && countOfMismatch < 10)
+        printf("Mismatch on %dx%d, game %d, move %d: sumOfHeight %d/%d, sumOfSquareOfHeight %d/%d, countOfHoles %d/%d, countOfBlockades %d/%d, maxHeight %d/%d\n",
+               W, H, game, move, f->sumOfHeight, sumOfHeight, f->sumOfSquareOfHeight, sumOfSquareOfHeight, f->countOfHoles, countOfHoles,
+               f->countOfBlockades, countOfBlockades, f->maxHeight, maxHeight);
+    return same;
+}
+
+/*
+ Checks the features of field(f) which are used to score plays against the original scan of cells of field.
+ Field is copied to cells as the original field of game (cell[i][j] > 0 if it is filled), and sum of heights,
+ SD of heights and the difference between max height and min height of edges are calculated cell by cell as the original search did.
+ Features of field are calculated from the incremental properties as searchPlay() and scoreFeature() do.
+ It prints the first mismatches and returns false if any feature is different.
+ */
+template<int W, int H> bool checkFeature(const Field<W, H> *f, int game, int move) {
+    int i, j, countOfBlocksOfColumn, sumOfHeight = 0, maxHeight = 0, minEdgeHeight = 0, heightDifference;
+    double averageOfHeight = 0, averageOfSquareOfHeight = 0, SDofHeight, SDofField;
+    char cell[H][W];
+    for(i = 0; i < H; i++)
+        for(j = 0; j < W; j++) cell[i][j] = (f->line[i] >> j) & 1;
+    for(i = 0; i < W; i++) {
+        countOfBlocksOfColumn = 0;
+        for(j = 0; j < H; j++) {
+            if(cell[j][i] > 0) {
+                if(countOfBlocksOfColumn == 0) {
+                    sumOfHeight += H - j;
+                    averageOfHeight += (double)(H - j);
+                    averageOfSquareOfHeight += ((double)(H - j) * (double)(H - j));
+                    maxHeight = (H - j > maxHeight) ? H - j : maxHeight;
+                    if(i == 0) minEdgeHeight = H - j;
+                    if(i == W - 1 && minEdgeHeight > H - j) minEdgeHeight = H - j;
+                }
+                countOfBlocksOfColumn++;
+            }
+        }
+        if((i == 0 || i == W - 1) && countOfBlocksOfColumn == 0) minEdgeHeight = 0;
+    }
+    averageOfHeight /= (double)W;
+    averageOfSquareOfHeight /= (double)W;
+    SDofHeight = sqrt(averageOfSquareOfHeight - averageOfHeight * averageOfHeight);
+
+    heightDifference = f->maxHeight - min(f->height[0], f->height[W - 1]);
+    SDofField = sqrt((double)f->sumOfSquareOfHeight / (double)W - ((double)f->sumOfHeight / (double)W) * ((double)f->sumOfHeight / (double)W));
+    if(f->sumOfHeight == sumOfHeight && heightDifference == maxHeight - minEdgeHeight && SDofField == SDofHeight) return true;
+    if(countOfMismatch < 10)
+        printf("Feature mismatch on %dx%d, game %d, move %d: sumOfHeight %d/%d, heightDifference %d/%d, SD of heights %f/%f\n",
+               W, H, game, move, f->sumOfHeight, sumOfHeight, heightDifference, maxHeight - minEdgeHeight, SDofField, SDofHeight);
+    return false;
+}
+
+/*
+ Plays seeded random placements on the board of W x H and checks the field after each of them.
+ Blocks are dropped at random rotation and x coordination, including plays which get out of the top of field.
+ */
+template<int W, int H> void testBoard(uint64_t seed) {
+    int game, move, id, r, x, y;
+    RANDOM rng;
+    Field<W, H> field;
+    for(game = 0; game < NUM_OF_TEST_GAME; game++) {
+        initRandom(&rng, splitSeed(seed, game));
+        initField(&field);
+        for(move = 0; move < NUM_OF_TEST_MOVE; move++) {
+            id = randomInt(&rng, NUM_OF_SHAPE);
+            r = randomInt(&rng, NUM_OF_ROTATE);
+            x = blockTable<W, H>.boundary[id][r].x1 + randomInt(&rng, blockTable<W, H>.boundary[id][r].x2 - blockTable<W, H>.boundary[id][r].x1 + 1);
+            y = getLandingY(&field, id, r, x);
+            addBlockToField(&field, id, r, y, x);
+            deleteLineFromField(&field);
+            countOfMove++;
+            if(!checkField(&field, game, move) || !checkFeature(&field, game, move)) countOfMismatch++;
+        }
+    }
+}
+
+/*
+ Tests the fitness cache with two weights in the same slot of cache. The first individual is not cached and replaces the entry of
+ the second individual, which has every game in cache. The second individual should still get the mean of its cached games,
+ and the entry should have the games of the first individual after the evaluation. It returns false if the fitness is wrong.
+ */
+bool testFitnessCache(uint64_t seed) {
+    int j;
+    CONFIG config;
+    TELEMETRY telemetry;
+    FITNESS *slot;
+    bool success;
+
+    initConfig(&config);
+    config.threadCount = 1;
+    config.seed = seed;
+    config.countOfPopulation = 2;
+    config.countOfTop = 1;
+    config.countOfPlay = 2;
+    config.fitnessCache = true;
+    config.maxPiece = 20;
+    checkConfig(&config);
+    initIslands(&config);
+    ISLAND *island = &islands[0];
+    vector<INDIVIDUAL> &population = island->population;
+    initPopulation(island);
+    // Makes the second weights until they have the same slot as the first weights.
+    slot = findFitness(island, population[0].weight);
+    do {
+        for(j = 0; j < NUM_OF_WEIGHTS; j++) population[1].weight[j] = randomDouble(&island->rng) * 5.0;
+    } while(findFitness(island, population[1].weight) != slot);
+    memcpy(slot->weight, population[1].weight, sizeof(slot->weight));
+    slot->sumOfScore = CACHED_SCORE * config.countOfPlay;
+    slot->sumOfPiece = 0;
+    slot->countOfGame = config.countOfPlay;
+
+    evaluatePopulation(&config, island, NULL, &telemetry);
+    success = population[1].score == CACHED_SCORE && telemetry.individual[1].countOfGame == 0
+           && memcmp(slot->weight, population[0].weight, sizeof(slot->weight)) == 0 && slot->countOfGame == config.countOfPlay
+           && slot->sumOfScore == population[0].score * config.countOfPlay;
+    printf("Fitness cache: scores %.2f/%.2f of the same slot, %s\n", population[0].score, population[1].score, success ? "ok" : "wrong");
+    freeIslands();
+    return success;
+}
+
+#ifdef COUNT_ALLOCATION
+/*
+ Plays games on every board after a warm-up game and checks that they don't allocate heap memory. (COUNT_ALLOCATION)
+ The warm-up game allocates the transposition table of the thread, and blocks of sequence are generated for the longest game before it,
+ as the first generation of learning does. It returns false if any game after the warm-up game allocates memory.
+ */
+bool testAllocation(uint64_t seed) {
+    int game, count = 0;
+    const double weight[NUM_OF_WEIGHTS] = {-1.0, -4.0, -1.0, 1.0, 1.0, 1.0, -1.0, -1.0};
+    GAME_OPTION option = {WIDTH, HEIGHT, BLOCK_NUM, 0, LIMIT_OF_ALLOCATION_PIECE};
+    PIECE_SEQUENCE sequence;
+    RANDOM rng;
+    GAME_STAT stat;
+
+    initPieceSequence(&sequence);
+    resetPieceSequence(&sequence, seed);
+    getPiece(&sequence, LIMIT_OF_ALLOCATION_PIECE + MAX_BLOCK_NUM);
+    initRandom(&rng, seed);
+    playTetris(weight, &option, &sequence, &rng, NULL, &stat);
+    allocationOfGame = 0;
+#define PLAY_BOARD(w, h) \
+    for(game = 0; game < NUM_OF_ALLOCATION_GAME; game++, count++) { \
+        option.width = w; \
+        option.height = h; \
+        resetPieceSequence(&sequence, splitSeed(seed, count)); \
+        initRandom(&rng, splitSeed(seed, count)); \
+        playTetris(weight, &option, &sequence, &rng, NULL, &stat); \
+    }
+    FOR_EACH_BOARD(PLAY_BOARD)
+#undef PLAY_BOARD
+    freePieceSequence(&sequence);
+    printf("Heap allocations of %d games after the warm-up game: %lld\n", count, allocationOfGame);
+    return allocationOfGame == 0;
+}
+#endif
+
+/*
+ Test of the field of every board and the fitness cache. It returns 1 if any property of field is different from the full scan,
+ or the fitness of cached weights is wrong.
+ */
+int main(int argc, char *argv[]) {
+    uint64_t seed = argc > 1 ? strtoull(argv[1], NULL, 10) : 1;
+    initTetris(true);
+#define TEST_BOARD(w, h) testBoard<w, h>(seed);
+    FOR_EACH_BOARD(TEST_BOARD)
+#undef TEST_BOARD
+    printf("%lld moves, %lld mismatches\n", countOfMove, countOfMismatch);
+    if(!testFitnessCache(seed)) return 1;
+#ifdef COUNT_ALLOCATION
+    if(!testAllocation(seed)) return 1;
+#endif
+    return countOfMismatch == 0 ? 0 : 1;
+}
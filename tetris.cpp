@@ -0,0 +1,672 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdint.h>
+#include <errno.h>
+#include <algorithm>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define USE_AVX2
+#endif
+#include "tetris.h"
+
+using namespace std;
+
+#ifdef COUNT_ALLOCATION
+/*
+ Counts heap allocations to check that games don't allocate memory. (make COUNT_ALLOCATION=1)
+ Every allocation function of C (malloc, calloc, realloc and aligned versions) is replaced by the function
+ which counts allocations of each thread and calls the function of glibc. operator new of C++ also calls malloc().
+ */
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *p, size_t size);
+extern "C" void *__libc_memalign(size_t alignment, size_t size);
+__thread long long allocationOfThread = 0;  // # of heap allocations of each thread.
+long long allocationOfGame = 0;             // # of heap allocations during games which are not displayed.
+extern "C" void *malloc(size_t size) {
+    allocationOfThread++;
+    return __libc_malloc(size);
+}
+extern "C" void *calloc(size_t count, size_t size) {
+    allocationOfThread++;
+    return __libc_calloc(count, size);
+}
+extern "C" void *realloc(void *p, size_t size) {
+    allocationOfThread++;
+    return __libc_realloc(p, size);
+}
+extern "C" void *memalign(size_t alignment, size_t size) {
+    allocationOfThread++;
+    return __libc_memalign(alignment, size);
+}
+extern "C" void *aligned_alloc(size_t alignment, size_t size) {
+    allocationOfThread++;
+    return __libc_memalign(alignment, size);
+}
+extern "C" int posix_memalign(void **p, size_t alignment, size_t size) {
+    allocationOfThread++;
+    *p = __libc_memalign(alignment, size);
+    return *p != NULL ? 0 : ENOMEM;
+}
+#endif
+
+/*
+ Random keys of Zobrist hashing on the board of W x H. Each line is hashed by its left and right halves. ([row][half][bits of half])
+ Keys of empty halves of lines are 0, so empty lines don't change the hash.
+ They are made at compile time, so searches don't depend on any initialization.
+ */
+template<int W, int H> struct ZobristTable {
+    uint64_t line[H][2][1 << ((W + 1) / 2)];
+    uint64_t level[MAX_BLOCK_NUM];
+};
+
+template<int W, int H> constexpr ZobristTable<W, H> makeZobristTable() {
+    ZobristTable<W, H> t = {};
+    int i = 0, j = 0, k = 0;
+    RANDOM rng = {};
+    initRandom(&rng, 0x5A0B1257ULL);
+    for(i = 0; i < H; i++)
+        for(j = 0; j < 2; j++)
+            for(k = 0; k < (1 << ((W + 1) / 2)); k++)
+                t.line[i][j][k] = (k == 0) ? 0 : nextRandom(&rng);
+    for(i = 0; i < MAX_BLOCK_NUM; i++) t.level[i] = nextRandom(&rng);
+    return t;
+}
+
+template<int W, int H> constexpr ZobristTable<W, H> zobristTable = makeZobristTable<W, H>();
+
+#ifdef USE_AVX2
+template<int W, int H> __attribute__((target("avx2"))) double scoreFeatureAVX2(Feature<W, H> *f, int count, const double *weight);
+#endif
+
+// Games score plays by AVX2 instructions. It is set by initTetris() according to CPU.
+bool simdOfGame = false;
+
+/*
+ Transposition table of games of each thread. It is allocated by the first game of the thread and kept for the next games.
+ The stamp of search is kept with it, so entries of previous games are ignored without clearing the table.
+ */
+static thread_local vector<TRANSPOSITION> tableOfThread;
+static thread_local unsigned int stampOfThread = 0;
+
+/*
+ Comparison function for compare the scores of two plays.
+ */
+bool candidateLessFunction(const CANDIDATE &a, const CANDIDATE &b) {
+    return a.score > b.score;
+}
+
+/*
+ Chooses whether games score plays by AVX2 instructions. It should be called once before playing games.
+ */
+void initTetris(bool simd) {
+    simdOfGame = checkSIMD(simd);
+}
+
+/*
+ Returns true if the engine is compiled for the board of width x height.
+ */
+bool checkBoard(int width, int height) {
+#define CHECK_BOARD(w, h) if(width == w && height == h) return true;
+    FOR_EACH_BOARD(CHECK_BOARD)
+#undef CHECK_BOARD
+    return false;
+}
+
+/*
+ Plays tetris game on the board of option by the engine of the board.
+ Boards of options are checked by checkBoard(), so the other boards are never played. Such games are over at once.
+ */
+int playTetris(const double *weight, const GAME_OPTION *option, PIECE_SEQUENCE *sequence, RANDOM *rng, DISPLAY *display, GAME_STAT *stat) {
+#define PLAY_ON_BOARD(w, h) if(option->width == w && option->height == h) return playTetrisOnBoard<w, h>(weight, option, sequence, rng, display, stat);
+    FOR_EACH_BOARD(PLAY_ON_BOARD)
+#undef PLAY_ON_BOARD
+    stat->countOfPiece = 0;
+    stat->countOfNode = 0;
+    return 0;
+}
+
+/*
+ Plays tetris game until it is over.
+ 1. The game will be initialized.
+ 2. Recommended play of current block will be obtained by calling getRecommendedPlay().
+    This will be presented as location(recommendX, recommendY) and rotation status(recommendR) of block.
+ 3. Current block will be stacked at field according to the recommended play and switched to the next block.
+    If current block gets out of the boundary of field, the game is over.
+ 4. After current block is stacked on the field successfully, score is updated and current block will be switched to next block.
+ 5. 2 ~ 4 will be iterated until game ends or the number of stacked blocks reaches the limit(option->limitOfPiece, 0: unlimited).
+ Plays are chosen by the weights of factors(weight). The number of stacked blocks and expanded nodes are stored at stat.
+ Blocks are read from sequence, so games with the same sequence get the same blocks. If sequence is NULL, blocks are drawn from rng.
+ rng is also used for choosing one of plays with the same score.
+ If display is not NULL, the field is drawn whenever block is stacked.
+ */
+template<int W, int H> int playTetrisOnBoard(const double *weight, const GAME_OPTION *option, PIECE_SEQUENCE *sequence, RANDOM *rng, DISPLAY *display, GAME_STAT *stat) {
+    int i;               // Variables for iterations.
+    long long countOfQueued;                // # of blocks which are put into the queue.
+    Field<W, H> field;                      // Field of game where blocks are stacked.
+    char color[MAX_HEIGHT][MAX_WIDTH];      // Colors of blocks stacked on the field. Only used for drawing the field.
+    int blockQueue[MAX_BLOCK_NUM];          // Queue of blocks. ([0]: Current block, [1]: Next block, ...)
+    int blockRotate, blockY, blockX;        // Recommended rotation(recommendR) and position(recommendX, recommendY) of current block.
+    int score;                   // Stores score of game.
+    Node<W, H> node[MAX_BLOCK_NUM + 1];     // Stack of nodes of state space tree. ([0]: Root node)
+    SEARCH search;                          // State of search of this game.
+#ifdef COUNT_ALLOCATION
+    long long countOfAllocation;            // # of heap allocations of the thread before the game.
+#endif
+    
+#ifdef COUNT_ALLOCATION
+    // Allocations of the whole game including its initialization are counted.
+    countOfAllocation = allocationOfThread;
+#endif
+    // Initializes the game.
+    initField(&field);
+    node[0].recField = field;
+    memset(color, 0, sizeof(color));
+    for(i = 0; i < option->depth; i++) blockQueue[i] = sequence != NULL ? getPiece(sequence, i) : randomInt(rng, NUM_OF_SHAPE);
+    countOfQueued = option->depth;
+    score = 0;
+    search.weight = weight;
+    search.simd = simdOfGame;
+    search.rng = rng;
+    search.depth = option->depth;
+    search.beamWidth = option->beamWidth;
+    if(tableOfThread.empty()) tableOfThread.assign(SIZE_OF_TRANSPOSITION, TRANSPOSITION());
+    search.table = tableOfThread.data();
+    search.stamp = stampOfThread;
+    search.countOfNode = 0;
+    
+    // Play game until it is over.
+    stat->countOfPiece = 0;
+    while(option->limitOfPiece == 0 || stat->countOfPiece < option->limitOfPiece) {
+        // Get the recommended play of current block.
+        getRecommendedPlay(&node[0], &blockRotate, &blockY, &blockX, blockQueue, &search);
+        // Check whether block will get out of the boundary of field by doing recommended play or not. If it does, game should be over.
+        if(blockY <= blockTable<W, H>.boundary[blockQueue[0]][blockRotate].y1 - 1) break;
+        // If block can be stacked on the field normally, add block to the field and update score.
+        score += addBlockToField(&field, blockQueue[0], blockRotate, blockY, blockX);
+        if(display != NULL) {
+            addBlockToColor(color, blockQueue[0], blockRotate, blockY, blockX);
+            deleteLineFromColor(color, &field);
+        }
+        score += deleteLineFromField(&field);
+        stat->countOfPiece++;
+        // Switch current blcok to next block.
+        for(i = 0; i < option->depth - 1; i++) blockQueue[i] = blockQueue[i + 1];
+        blockQueue[i] = sequence != NULL ? getPiece(sequence, countOfQueued) : randomInt(rng, NUM_OF_SHAPE);
+        countOfQueued++;
+        node[0].recField = field;
+        if(display != NULL) display->draw(display->arg, color, score);
+    }
+#ifdef COUNT_ALLOCATION
+    if(display == NULL) {
+        #pragma omp atomic
+        allocationOfGame += allocationOfThread - countOfAllocation;
+    }
+#endif
+    stampOfThread = search.stamp;
+    stat->countOfNode = search.countOfNode;
+    // Game is over. Return the score of the game.
+    return score;
+}
+
+/*
+ Initializes the empty piece sequence. Chunks are allocated later when they are needed.
+ */
+void initPieceSequence(PIECE_SEQUENCE *sequence) {
+    memset(sequence->chunk, 0, sizeof(sequence->chunk));
+    sequence->countOfPiece = 0;
+    omp_init_lock(&sequence->lock);
+}
+
+/*
+ Starts the new sequence of blocks from seed. It should not be called while games are reading the sequence.
+ */
+void resetPieceSequence(PIECE_SEQUENCE *sequence, uint64_t seed) {
+    initRandom(&sequence->rng, seed);
+    sequence->countOfPiece = 0;
+}
+
+void freePieceSequence(PIECE_SEQUENCE *sequence) {
+    int i;
+    for(i = 0; i < MAX_CHUNK; i++) free(sequence->chunk[i]);
+    omp_destroy_lock(&sequence->lock);
+}
+
+/*
+ Returns the block of index of sequence. If the block isn't generated yet, next WORD_PER_GENERATION words of blocks are generated.
+ */
+int getPiece(PIECE_SEQUENCE *sequence, long long index) {
+    long long word, count, end;
+    uint64_t bits;
+    int i;
+    
+    index %= (long long)MAX_CHUNK * WORD_PER_CHUNK * PIECE_PER_WORD;
+    if(index >= sequence->countOfPiece.load(memory_order_acquire)) {
+        omp_set_lock(&sequence->lock);
+        // Other game could generate the block while this game is waiting for the lock.
+        count = sequence->countOfPiece.load(memory_order_relaxed);
+        end = (index / PIECE_PER_WORD + WORD_PER_GENERATION) * PIECE_PER_WORD;
+        for(; count <= index || count < end; count += PIECE_PER_WORD) {
+            word = count / PIECE_PER_WORD;
+            if(word >= (long long)MAX_CHUNK * WORD_PER_CHUNK) break;
+            if(sequence->chunk[word / WORD_PER_CHUNK] == NULL)
+                sequence->chunk[word / WORD_PER_CHUNK] = (uint64_t*)malloc(WORD_PER_CHUNK * sizeof(uint64_t));
+            bits = 0;
+            for(i = 0; i < PIECE_PER_WORD; i++) bits |= (uint64_t)randomInt(&sequence->rng, NUM_OF_SHAPE) << (i * BITS_OF_PIECE);
+            sequence->chunk[word / WORD_PER_CHUNK][word % WORD_PER_CHUNK] = bits;
+        }
+        sequence->countOfPiece.store(count, memory_order_release);
+        omp_unset_lock(&sequence->lock);
+    }
+    word = index / PIECE_PER_WORD;
+    return (sequence->chunk[word / WORD_PER_CHUNK][word % WORD_PER_CHUNK] >> (index % PIECE_PER_WORD * BITS_OF_PIECE)) & ((1 << BITS_OF_PIECE) - 1);
+}
+
+/*
+ Returns random integer in range of 0 ~ n - 1.
+ */
+int randomInt(RANDOM *rng, int n) {
+    return (int)(((nextRandom(rng) >> 32) * (uint64_t)n) >> 32);
+}
+
+/*
+ Returns random real number in range of 0 ~ 1.
+ */
+double randomDouble(RANDOM *rng) {
+    return (double)(nextRandom(rng) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/*
+ Returns Zobrist hash of field(f) at the level of state space tree.
+ */
+template<int W, int H> uint64_t hashField(const Field<W, H> *f, int level) {
+    int i;
+    uint64_t hash = zobristTable<W, H>.level[level];
+    for(i = 0; i < H; i++)
+        hash ^= zobristTable<W, H>.line[i][0][f->line[i] & ((1 << ((W + 1) / 2)) - 1)] ^ zobristTable<W, H>.line[i][1][f->line[i] >> ((W + 1) / 2)];
+    return hash;
+}
+
+/*
+ Initializes the field as empty.
+ */
+template<int W, int H> void initField(Field<W, H> *f) {
+    memset(f, 0, sizeof(Field<W, H>));
+}
+
+/*
+ Initializes the field from bit masks of lines. (Bit j of line[i] is set if the cell of i-th row and j-th column is filled.)
+ Heights and holes of columns are counted from the lines, so the field is the same as the field made by stacking blocks.
+ */
+template<int W, int H> void initFieldFromLines(Field<W, H> *f, const unsigned short line[H]) {
+    int i, j, top, blocks;
+    initField(f);
+    memcpy(f->line, line, sizeof(f->line));
+    for(j = 0; j < W; j++) {
+        for(top = 0; top < H && ((line[top] >> j) & 1) == 0; top++);
+        for(i = top, blocks = 0; i < H; i++) blocks += (line[i] >> j) & 1;
+        updateColumnOfField(f, j, H - top, H - top - blocks);
+        if(f->height[j] > f->maxHeight) f->maxHeight = f->height[j];
+    }
+}
+
+/*
+ Updates the height and the number of holes of the column of field.
+ Sums of properties of field are updated by removing the old values of the column and adding the new values.
+ */
+template<int W, int H> void updateColumnOfField(Field<W, H> *f, int column, int height, int holes) {
+    int oldHeight = f->height[column], oldHoles = f->holes[column];
+    f->sumOfHeight += height - oldHeight;
+    f->sumOfSquareOfHeight += height * height - oldHeight * oldHeight;
+    f->countOfHoles += holes - oldHoles;
+    if(oldHoles > 0) f->countOfBlockades -= oldHeight - oldHoles;
+    if(holes > 0) f->countOfBlockades += height - holes;
+    f->height[column] = height;
+    f->holes[column] = holes;
+}
+
+/*
+ Checks whether block(blockId) can be moved to the location(blockX, blockY) of field(f) with rotation status(blockRotate) or not.
+ It returns true if block can be moved, or returns false if block cannot be moved.
+ */
+template<int W, int H> bool checkBlockCanMove(const Field<W, H> *f, int blockId, int blockRotate, int blockY, int blockX) {
+    int i;
+    const unsigned short *mask;
+    if(blockX < blockTable<W, H>.boundary[blockId][blockRotate].x1 || blockX > blockTable<W, H>.boundary[blockId][blockRotate].x2) return false;
+    mask = blockTable<W, H>.mask[blockId][blockRotate][blockX + MASK_OFFSET];
+    for(i = 0; i < BLOCK_HEIGHT; i++)
+        if(mask[i] != 0 && (blockY + i >= H || (blockY + i >= 0 && (f->line[blockY + i] & mask[i]) != 0)))
+            return false;
+    return true;
+}
+
+/*
+ Returns y coordination where block(blockId) lands when it is dropped from the top of field at x coordination(blockX).
+ Block stops right above the highest of stacks of columns where its lowest cells are, so it is obtained from heights of columns.
+ */
+template<int W, int H> int getLandingY(const Field<W, H> *f, int blockId, int blockRotate, int blockX) {
+    int j, y = H;
+    const Profile *p = &blockTable<W, H>.profile[blockId][blockRotate];
+    for(j = 0; j < BLOCK_WIDTH; j++)
+        if(p->bottom[j] >= 0) y = min(y, H - f->height[blockX + j] - 1 - p->bottom[j]);
+    return y;
+}
+
+/*
+ Adds block to the field.
+ Block should be dropped from the top of field, so every cell of block is above the stack of its column.
+ Only the columns where block is added are updated: empty cells between block and the stack of column become holes.
+ It returns 10 * the number of sides of block that touches the bottom of the field.
+ */
+template<int W, int H> int addBlockToField(Field<W, H> *f, int blockId, int blockRotate, int blockY, int blockX) {
+    int i, j, top, bottom, touched = 0;
+    const unsigned short *mask = blockTable<W, H>.mask[blockId][blockRotate][blockX + MASK_OFFSET];
+    const Profile *p = &blockTable<W, H>.profile[blockId][blockRotate];
+    // Sides are counted before any row of block is added, so the block itself is not counted as the bottom.
+    for(i = 0; i < BLOCK_HEIGHT; i++)
+        if(mask[i] != 0 && i + blockY >= 0)
+            touched += __builtin_popcount(mask[i] & (i + blockY + 1 >= H ? FULL_LINE_OF(W) : f->line[i + blockY + 1]));
+    for(i = 0; i < BLOCK_HEIGHT; i++)
+        if(mask[i] != 0 && i + blockY >= 0 && i + blockY < H) f->line[i + blockY] |= mask[i];
+    for(j = 0; j < BLOCK_WIDTH; j++) {
+        // Cells which get out of the top of field are not added.
+        if(p->bottom[j] < 0 || blockY + p->bottom[j] < 0) continue;
+        top = max(0, blockY + p->top[j]);
+        bottom = blockY + p->bottom[j];
+        updateColumnOfField(f, blockX + j, H - top, f->holes[blockX + j] + (H - f->height[blockX + j]) - bottom - 1);
+        if(H - top > f->maxHeight) f->maxHeight = H - top;
+    }
+    return touched * 10;
+}
+
+/*
+ Deletes complete lines of the fields.
+ it returns 100 * the square of the number of complete lines.
+ */
+template<int W, int H> int deleteLineFromField(Field<W, H> *f) {
+    int cnt = 0, i, j, top, blocks;
+    for(i = j = H - 1; i >= 0; i--) {
+        if(f->line[i] == FULL_LINE_OF(W)) cnt++;
+        else f->line[j--] = f->line[i];
+    }
+    if(cnt == 0) return 0;
+    for(; j >= 0; j--) f->line[j] = 0;
+    // Every column loses one block per deleted line. Lines above the stack of column are moved down by cnt.
+    // If the top of column was deleted, the new top is searched from there as holes below it can be uncovered.
+    f->maxHeight = 0;
+    for(j = 0; j < W; j++) {
+        blocks = f->height[j] - f->holes[j] - cnt;
+        top = H - f->height[j] + cnt;
+        while(blocks > 0 && ((f->line[top] >> j) & 1) == 0) top++;
+        if(blocks > 0) updateColumnOfField(f, j, H - top, H - top - blocks);
+        else updateColumnOfField(f, j, 0, 0);
+        if(f->height[j] > f->maxHeight) f->maxHeight = f->height[j];
+    }
+    return cnt * cnt * 100;
+}
+
+/*
+ Adds colors of block to the color array of field.
+ */
+void addBlockToColor(char c[MAX_HEIGHT][MAX_WIDTH], int blockId, int blockRotate, int blockY, int blockX) {
+    int i, j;
+    for(i = 0; i < BLOCK_HEIGHT; i++)
+        for(j = 0; j < BLOCK_WIDTH; j++)
+            if(block[blockId][blockRotate][i][j] == 1 && i + blockY >= 0)
+                c[i + blockY][j + blockX] = blockId + 1;
+}
+
+/*
+ Deletes colors of complete lines of field(f) from the color array.
+ It should be called before deleteLineFromField() deletes complete lines from the field.
+ */
+template<int W, int H> void deleteLineFromColor(char c[MAX_HEIGHT][MAX_WIDTH], const Field<W, H> *f) {
+    int i, j;
+    for(i = j = H - 1; i >= 0; i--) {
+        if(f->line[i] == FULL_LINE_OF(W)) continue;
+        if(j != i) memcpy(c[j], c[i], W);
+        j--;
+    }
+    for(; j >= 0; j--) memset(c[j], 0, W);
+}
+
+/*
+ Returns true if simd is TRUE and CPU supports AVX2, so plays can be scored by AVX2 instructions.
+ */
+bool checkSIMD(bool simd) {
+#ifdef USE_AVX2
+    return simd && __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+/*
+ Calculates scores of count plays from their features(f) and the weights of factors, and returns the maximum of them.
+ AVX2 version is used if simd is TRUE. (It should be the result of checkSIMD()) Otherwise scalar version is used.
+ Both versions calculate in the same order, so they return exactly the same scores.
+ */
+template<int W, int H> double scoreFeature(Feature<W, H> *f, int count, const double *weight, bool simd) {
+#ifdef USE_AVX2
+    if(simd) return scoreFeatureAVX2(f, count, weight);
+#endif
+    return scoreFeatureScalar(f, count, weight);
+}
+
+/*
+ Calculates scores of count plays from their features(f) and the weights of factors.
+ Scores are stored in f->score and the maximum of them is returned.
+ */
+template<int W, int H> double scoreFeatureScalar(Feature<W, H> *f, int count, const double *weight) {
+    int i;
+    double averageOfHeight, averageOfSquareOfHeight, SDofHeight;        // Variables for calculating standard deviation of height.
+    double score, bestScore = 0;
+    for(i = 0; i < count; i++) {
+        averageOfHeight = (double)f->sumOfHeight[i] / (double)W;
+        averageOfSquareOfHeight = (double)f->sumOfSquareOfHeight[i] / (double)W;
+        SDofHeight = sqrt(averageOfSquareOfHeight - averageOfHeight * averageOfHeight);
+        score = (double)f->touched[i] * weight[3];
+        score += (double)f->removed[i] * weight[4];
+        score += weight[0] * f->sumOfHeight[i];
+        score += weight[1] * f->countOfHoles[i];
+        score += weight[2] * f->countOfBlockades[i];
+        score += weight[5] * f->countOfWallSides[i];
+        score += weight[6] * SDofHeight;
+        score += weight[7] * f->heightDifference[i];
+        f->score[i] = score;
+        if(i == 0 || score > bestScore) bestScore = score;
+    }
+    return bestScore;
+}
+
+#ifdef USE_AVX2
+/*
+ AVX2 version of scoreFeatureScalar(). 4 plays are scored at once.
+ Features after the last play are filled with 0 up to the multiple of 4, and their scores are ignored.
+ */
+template<int W, int H> __attribute__((target("avx2"))) double scoreFeatureAVX2(Feature<W, H> *f, int count, const double *weight) {
+    int i;
+    double bestScore = 0;
+    __m256d averageOfHeight, averageOfSquareOfHeight, score;
+    __m256d width = _mm256_set1_pd((double)W);
+    __m256d w[NUM_OF_WEIGHTS];
+    for(i = 0; i < NUM_OF_WEIGHTS; i++) w[i] = _mm256_set1_pd(weight[i]);
+    for(i = count; i % 4 != 0; i++)
+        f->touched[i] = f->removed[i] = f->sumOfHeight[i] = f->sumOfSquareOfHeight[i] = f->countOfHoles[i] = f->countOfBlockades[i] = f->countOfWallSides[i] = f->heightDifference[i] = 0;
+#define LOAD_FEATURE(a) _mm256_cvtepi32_pd(_mm_load_si128((const __m128i*)&f->a[i]))
+    for(i = 0; i < count; i += 4) {
+        averageOfHeight = _mm256_div_pd(LOAD_FEATURE(sumOfHeight), width);
+        averageOfSquareOfHeight = _mm256_div_pd(LOAD_FEATURE(sumOfSquareOfHeight), width);
+        score = _mm256_mul_pd(LOAD_FEATURE(touched), w[3]);
+        score = _mm256_add_pd(score, _mm256_mul_pd(LOAD_FEATURE(removed), w[4]));
+        score = _mm256_add_pd(score, _mm256_mul_pd(w[0], LOAD_FEATURE(sumOfHeight)));
+        score = _mm256_add_pd(score, _mm256_mul_pd(w[1], LOAD_FEATURE(countOfHoles)));
+        score = _mm256_add_pd(score, _mm256_mul_pd(w[2], LOAD_FEATURE(countOfBlockades)));
+        score = _mm256_add_pd(score, _mm256_mul_pd(w[5], LOAD_FEATURE(countOfWallSides)));
+        score = _mm256_add_pd(score, _mm256_mul_pd(w[6], _mm256_sqrt_pd(_mm256_sub_pd(averageOfSquareOfHeight, _mm256_mul_pd(averageOfHeight, averageOfHeight)))));
+        score = _mm256_add_pd(score, _mm256_mul_pd(w[7], LOAD_FEATURE(heightDifference)));
+        _mm256_store_pd(&f->score[i], score);
+    }
+#undef LOAD_FEATURE
+    for(i = 0; i < count; i++)
+        if(i == 0 || f->score[i] > bestScore) bestScore = f->score[i];
+    return bestScore;
+}
+#endif
+
+/*
+ Returns recommended play of current block.
+ It will be obtained by using state space tree and DFS.
+ Each node of tree has accumulated score after block is stacked on the field with corresponding location and rotation state.
+ Scores of each play will be calculated according to the weights of current individual of genetic algorithm.
+ Every nodes in the same depth(level) use the same order of block in blcokQueue. But its location and rotation state is different.
+ Parent node of child nodes choose one of them which shows the best performance.
+ Therefore, root node of tree makes child nodes which stack current block(blockQueue[0]) and then select the best one of them.
+ Recursively, they make next level of child nodes which stack next blokc(blockQueue[1]) and then select the best one of them.
+ By DFS, the root node will hold the best play using all the blocks in blockQueue.
+ The best play will be returned by storing values at the pointer parameters of function: location(blockX, blockY) and rotation(blockRotate) of block.
+ Depth and level are template arguments of searchPlay(), so the search of each depth is compiled with its levels unrolled.
+ */
+template<int W, int H> void getRecommendedPlay(Node<W, H> *root, int *blockRotate, int *blockY, int *blockX, int blockQueue[], SEARCH *search) {
+    static_assert(MAX_BLOCK_NUM == 6, "Search of each depth should be listed.");
+    // Entries of transposition table stored by previous searches are ignored, as blocks of queue are different.
+    // If stamp goes around, entries of old searches could have the same stamp, so the table is cleared.
+    if(++search->stamp == 0) {
+        memset(search->table, 0, SIZE_OF_TRANSPOSITION * sizeof(TRANSPOSITION));
+        search->stamp = 1;
+    }
+    switch(search->depth) {
+        case 1: searchPlay<W, H, 1, 0>(root, blockQueue, search); break;
+        case 2: searchPlay<W, H, 2, 0>(root, blockQueue, search); break;
+        case 3: searchPlay<W, H, 3, 0>(root, blockQueue, search); break;
+        case 4: searchPlay<W, H, 4, 0>(root, blockQueue, search); break;
+        case 5: searchPlay<W, H, 5, 0>(root, blockQueue, search); break;
+        default: searchPlay<W, H, 6, 0>(root, blockQueue, search); break;
+    }
+    *blockRotate = root->blockRotate;
+    *blockY = root->blockY;
+    *blockX = root->blockX;
+}
+
+/*
+ Returns the best accumulated score of plays of blocks from blockQueue[L] to the last block of queue. (L: level of parent, D: depth of search)
+ The best play of the block of this level is stored in the parent node.
+ 1. Every play of block is scored by the field after the play.
+ 2. If there are blocks to be considered in the blockQueue, the best beamWidth plays are chosen by their scores and DFS is done for them.
+    Accumulated score of play is its score + the best accumulated score of its child node.
+ 3. Accumulated scores of fields which are reached by different orders of plays are stored in transposition table and computed only once.
+ */
+template<int W, int H, int D, int L> double searchPlay(Node<W, H> *parent, int blockQueue[], SEARCH *search) {
+    int r, x, y, i, n, id = blockQueue[L];                      // r: rotation state, x: x coordination, y: y coordination, i: for iterations, id: block of this level.
+    double score, bestScore = 0;
+    int countOfChild;
+    bool scoreUpdateFlag = false;                               // Set TRUE once bestScore is updated by child node.
+    Node<W, H> *child = parent + 1;                             // As we are using DFS, not BFS, only one child node exists simultaneously.
+    CANDIDATE *c;
+    Feature<W, H> *f = &parent->feature;
+    uint64_t key = 0;
+    TRANSPOSITION *entry = NULL;
+    
+    // The field of root node is different for every search, so only the child nodes are looked up.
+    if(L > 0) {
+        key = hashField(&parent->recField, L);
+        entry = &search->table[key & (SIZE_OF_TRANSPOSITION - 1)];
+        if(entry->stamp == search->stamp && entry->key == key) return entry->score;
+    }
+    
+    search->countOfNode++;
+    // Now creates plays of the block of blockQueue according to the current depth(level) of tree.
+    // Set the rotation of block. Rotations which have the same shape are skipped.
+    parent->countOfCandidate = 0;
+    for(r = 0; r < rotateNum[id]; r++) {
+        // Set the x coordination of block.
+        for(x = blockTable<W, H>.boundary[id][r].x1; x <= blockTable<W, H>.boundary[id][r].x2; x++) {
+            // Set the y coordination of block where it touches the stack of field or floor.
+            y = getLandingY(&parent->recField, id, r, x);
+            n = parent->countOfCandidate++;
+            // Copy the field from the parent node.
+            child->recField = parent->recField;
+            // Count the number of sides of block that touches the wall.
+            f->countOfWallSides[n] = 0;
+            for(i = 0; i < BLOCK_HEIGHT; i++)
+                f->countOfWallSides[n] += __builtin_popcount(blockTable<W, H>.mask[id][r][x + MASK_OFFSET][i] & WALL_LINE_OF(W));
+            // Add block to the field at the location of (x, y) with rotation(r) and delete complete lines.
+            f->touched[n] = addBlockToField(&child->recField, id, r, y, x);
+            f->removed[n] = deleteLineFromField(&child->recField);
+            // Get sum of height, the number of holes and blockades, maximum of height and minimun of height of edges.
+            // They are already updated by addBlockToField() and deleteLineFromField().
+            f->sumOfHeight[n] = child->recField.sumOfHeight;
+            f->sumOfSquareOfHeight[n] = child->recField.sumOfSquareOfHeight;
+            f->countOfHoles[n] = child->recField.countOfHoles;
+            f->countOfBlockades[n] = child->recField.countOfBlockades;
+            f->heightDifference[n] = child->recField.maxHeight - min(child->recField.height[0], child->recField.height[W - 1]);
+            c = &parent->candidate[n];
+            c->blockX = x;
+            c->blockY = y;
+            c->blockRotate = r;
+        }
+    }
+    // Score all plays at once.
+    bestScore = scoreFeature(f, parent->countOfCandidate, search->weight, search->simd);
+    
+    // The last level only needs the best score, as only the play of root node is used.
+    if(L == 0 || L + 1 < D) {
+        for(i = 0; i < parent->countOfCandidate; i++) parent->candidate[i].score = f->score[i];
+        // If there are blocks to be considered in the blockQueue, do recursive for the best beamWidth plays.
+        countOfChild = parent->countOfCandidate;
+        if(L + 1 < D && search->beamWidth > 0 && search->beamWidth < countOfChild) {
+            nth_element(parent->candidate, parent->candidate + search->beamWidth - 1, parent->candidate + countOfChild, candidateLessFunction);
+            countOfChild = search->beamWidth;
+        }
+        for(i = 0; i < countOfChild; i++) {
+            c = &parent->candidate[i];
+            score = c->score;
+            if(L + 1 < D) {
+                child->recField = parent->recField;
+                addBlockToField(&child->recField, id, c->blockRotate, c->blockY, c->blockX);
+                deleteLineFromField(&child->recField);
+                // The last level never gets here, so it doesn't instantiate the level after it.
+                score += searchPlay<W, H, D, (L + 1 < D ? L + 1 : L)>(child, blockQueue, search);
+            }
+            // Parent node should recommend the situation of location and rotation which shows the best performance.
+            // Best score of parent node will be contiuously updated whenever child node finishes DFS.
+            if(scoreUpdateFlag == false || score > bestScore || (score == bestScore && randomInt(search->rng, 2) == 0)) {
+                scoreUpdateFlag = true;
+                bestScore = score;
+                parent->blockX = c->blockX;
+                parent->blockY = c->blockY;
+                parent->blockRotate = c->blockRotate;
+            }
+        }
+    }
+    
+    if(entry != NULL) {
+        entry->key = key;
+        entry->score = bestScore;
+        entry->stamp = search->stamp;
+    }
+    return bestScore;
+}
+
+/*
+ Engine of each board. Functions which are used out of this file are compiled here for every board.
+ */
+#define INSTANTIATE_BOARD(w, h) \
+    template int playTetrisOnBoard<w, h>(const double *weight, const GAME_OPTION *option, PIECE_SEQUENCE *sequence, RANDOM *rng, DISPLAY *display, GAME_STAT *stat); \
+    template uint64_t hashField<w, h>(const Field<w, h> *f, int level); \
+    template double scoreFeature<w, h>(Feature<w, h> *f, int count, const double *weight, bool simd); \
+    template double scoreFeatureScalar<w, h>(Feature<w, h> *f, int count, const double *weight); \
+    template void initField<w, h>(Field<w, h> *f); \
+    template void initFieldFromLines<w, h>(Field<w, h> *f, const unsigned short line[h]); \
+    template void updateColumnOfField<w, h>(Field<w, h> *f, int column, int height, int holes); \
+    template bool checkBlockCanMove<w, h>(const Field<w, h> *f, int blockId, int blockRotate, int blockY, int blockX); \
+    template int getLandingY<w, h>(const Field<w, h> *f, int blockId, int blockRotate, int blockX); \
+    template int addBlockToField<w, h>(Field<w, h> *f, int blockId, int blockRotate, int blockY, int blockX); \
+    template int deleteLineFromField<w, h>(Field<w, h> *f); \
+    template void deleteLineFromColor<w, h>(char c[MAX_HEIGHT][MAX_WIDTH], const Field<w, h> *f); \
+    template void getRecommendedPlay<w, h>(Node<w, h> *root, int *blockRotate, int *blockY, int *blockX, int blockQueue[], SEARCH *search);
+FOR_EACH_BOARD(INSTANTIATE_BOARD)
+#undef INSTANTIATE_BOARD
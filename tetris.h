@@ -0,0 +1,382 @@
+#ifndef tetris_h
+#define tetris_h
+
+#include <stdint.h>
+#include <atomic>
+#include <omp.h>
+
+#define WIDTH 10                             // Width of the default board.
+#define HEIGHT 22                            // Height of the default board.
+#define MAX_WIDTH 12                         // Maximum width of boards. (Lines are stored in unsigned short)
+#define MAX_HEIGHT 24                        // Maximum height of boards.
+#define NUM_OF_SHAPE 7
+#define NUM_OF_ROTATE 4
+#define BLOCK_HEIGHT 4
+#define BLOCK_WIDTH 4
+#define BLOCK_NUM 2                          // Default # of blocks to look ahead. (Depth of state space tree)
+#define MAX_BLOCK_NUM 6                      // Maximum # of blocks to look ahead.
+#define MAX_CANDIDATE_OF(w) (NUM_OF_ROTATE * (w))   // Maximum # of plays of a block on the board of width w.
+#define MAX_CANDIDATE MAX_CANDIDATE_OF(WIDTH)
+#define SIZE_OF_TRANSPOSITION (1 << 12)      // # of entries of transposition table of each game.
+#define FULL_LINE_OF(w) ((1 << (w)) - 1)     // Bit mask of a complete line of the board of width w.
+#define FULL_LINE FULL_LINE_OF(WIDTH)        // (0x3FF)
+#define WALL_LINE_OF(w) (1 | (1 << ((w) - 1)))  // Bit mask of the leftmost and rightmost columns.
+#define MASK_OFFSET (BLOCK_WIDTH - 1)       // Offset of x coordination in blockMask (x can be -3 ~ width - 1).
+#define BITS_OF_PIECE 3                      // # of bits of a block of piece sequence.
+#define PIECE_PER_WORD (64 / BITS_OF_PIECE)  // # of blocks packed in a word of piece sequence. (21)
+#define WORD_PER_CHUNK 1024                  // # of words of a chunk of piece sequence.
+#define MAX_CHUNK 4096                       // Maximum # of chunks of piece sequence. (About 88 million blocks)
+#define WORD_PER_GENERATION 64               // # of words generated at once when game needs more blocks.
+
+#define NUM_OF_WEIGHTS 8
+
+/*
+ Boards which have engines. (Width, height) The first board is the default board.
+ Engine is compiled for each board, so every loop over the field has constant bounds and is specialized for the board.
+ */
+#define FOR_EACH_BOARD(F) F(10, 22) F(10, 20) F(12, 24)
+#define BOARD_NAME(w, h) " " #w "x" #h
+#define BOARD_NAMES FOR_EACH_BOARD(BOARD_NAME)  // Names of boards for messages. (" 10x22 10x20 12x24")
+
+constexpr char block[NUM_OF_SHAPE][NUM_OF_ROTATE][BLOCK_HEIGHT][BLOCK_WIDTH] ={
+    /*  ▢▢▢▢    ▢▩▢▢    ▢▢▢▢    ▢▩▢▢
+        ▩▩▩▩    ▢▩▢▢    ▩▩▩▩    ▢▩▢▢
+        ▢▢▢▢    ▢▩▢▢    ▢▢▢▢    ▢▩▢▢
+        ▢▢▢▢    ▢▩▢▢    ▢▢▢▢    ▢▩▢▢ */
+    {
+        {{0, 0, 0, 0}, {1, 1, 1, 1}, {0, 0, 0, 0}, {0, 0, 0, 0}},
+        {{0, 1, 0, 0}, {0, 1, 0, 0}, {0, 1, 0, 0}, {0, 1, 0, 0}},
+        {{0, 0, 0, 0}, {1, 1, 1, 1}, {0, 0, 0, 0}, {0, 0, 0, 0}},
+        {{0, 1, 0, 0}, {0, 1, 0, 0}, {0, 1, 0, 0}, {0, 1, 0, 0}}
+    },
+    /*  ▢▢▢▢    ▢▢▢▢    ▢▢▢▢    ▢▢▢▢
+        ▢▢▢▢    ▢▢▩▩    ▢▩▢▢    ▢▢▩▢
+        ▢▩▩▩    ▢▢▩▢    ▢▩▩▩    ▢▢▩▢
+        ▢▢▢▩    ▢▢▩▢    ▢▢▢▢    ▢▩▩▢ */
+    {
+        {{0, 0, 0, 0}, {0, 0, 0, 0}, {0, 1, 1, 1}, {0, 0, 0, 1}},
+        {{0, 0, 0, 0}, {0, 0 ,1, 1}, {0, 0, 1, 0}, {0, 0, 1, 0}},
+        {{0, 0, 0, 0}, {0, 1, 0, 0}, {0, 1, 1, 1}, {0, 0, 0, 0}},
+        {{0, 0, 0, 0}, {0, 0, 1, 0}, {0, 0, 1, 0}, {0, 1, 1, 0}}
+    },
+    /*  ▢▢▢▢    ▢▢▢▢    ▢▢▢▢    ▢▢▢▢
+        ▢▢▢▢    ▢▢▩▢    ▢▢▢▩    ▢▩▩▢
+        ▢▩▩▩    ▢▢▩▢    ▢▩▩▩    ▢▩▢▢
+        ▢▩▢▢    ▢▢▩▩    ▢▢▢▢    ▢▩▢▢ */
+    {
+        {{0, 0, 0, 0}, {0, 0, 0, 0}, {0, 1, 1, 1}, {0, 1, 0, 0}},
+        {{0, 0, 0, 0}, {0, 0, 1, 0}, {0, 0, 1, 0}, {0, 0, 1, 1}},
+        {{0, 0, 0, 0}, {0, 0, 0, 1}, {0, 1, 1, 1}, {0, 0, 0, 0}},
+        {{0, 0, 0, 0}, {0, 1, 1, 0}, {0, 0, 1, 0}, {0, 0, 1, 0}}
+    },
+    /*  ▢▢▢▢    ▢▩▢▢    ▢▢▢▢    ▢▢▢▢
+        ▢▩▢▢    ▩▩▢▢    ▢▢▢▢    ▢▩▢▢
+        ▩▩▩▢    ▢▩▢▢    ▩▩▩▢    ▢▩▩▢
+        ▢▢▢▢    ▢▢▢▢    ▢▩▢▢    ▢▩▢▢ */
+    {
+        {{0, 0, 0, 0}, {0, 1, 0, 0}, {1, 1, 1, 0}, {0, 0, 0, 0}},
+        {{0, 0, 0, 0}, {0, 1, 0, 0}, {1, 1, 0, 0}, {0, 1, 0, 0}},
+        {{0, 0, 0, 0}, {0, 0, 0, 0}, {1, 1, 1, 0}, {0, 1, 0, 0}},
+        {{0, 0, 0, 0}, {0, 1, 0, 0}, {0, 1, 1, 0}, {0, 1, 0, 0}}
+    },
+    /*  ▢▢▢▢    ▢▢▢▢    ▢▢▢▢    ▢▢▢▢
+        ▢▢▢▢    ▢▢▢▢    ▢▢▢▢    ▢▢▢▢
+        ▢▩▩▢    ▢▩▩▢    ▢▩▩▢    ▢▩▩▢
+        ▢▩▩▢    ▢▩▩▢    ▢▩▩▢    ▢▩▩▢ */
+    {
+        {{0, 0, 0, 0}, {0, 0, 0, 0}, {0, 1, 1, 0}, {0, 1, 1, 0}},
+        {{0, 0, 0, 0}, {0, 0, 0, 0}, {0, 1, 1, 0}, {0, 1, 1, 0}},
+        {{0, 0, 0, 0}, {0, 0, 0, 0}, {0, 1, 1, 0}, {0, 1, 1, 0}},
+        {{0, 0, 0, 0}, {0, 0, 0, 0}, {0, 1, 1, 0}, {0, 1, 1, 0}}
+    },
+    /*  ▢▢▢▢    ▢▢▢▢    ▢▢▢▢    ▢▢▢▢
+        ▢▢▩▩    ▢▩▢▢    ▢▢▩▩    ▢▩▢▢
+        ▢▩▩▢    ▢▩▩▢    ▢▩▩▢    ▢▩▩▢
+        ▢▢▢▢    ▢▢▩▢    ▢▢▢▢    ▢▢▩▢ */
+    {
+        {{0, 0, 0, 0}, {0, 0, 1, 1}, {0, 1, 1, 0}, {0, 0, 0, 0}},
+        {{0, 0, 0, 0}, {0, 1, 0, 0}, {0, 1, 1, 0}, {0, 0, 1, 0}},
+        {{0, 0, 0, 0}, {0, 0, 1, 1}, {0, 1, 1, 0}, {0, 0, 0, 0}},
+        {{0, 0, 0, 0}, {0, 1, 0, 0}, {0, 1, 1, 0}, {0, 0, 1, 0}}
+    },
+    /*  ▢▢▢▢    ▢▢▢▢    ▢▢▢▢    ▢▢▢▢
+        ▢▢▢▢    ▢▢▩▢    ▢▢▢▢    ▢▢▩▢
+        ▢▩▩▢    ▢▩▩▢    ▢▩▩▢    ▢▩▩▢
+        ▢▢▩▩    ▢▩▢▢    ▢▢▩▩    ▢▩▢▢ */
+    {
+        {{0, 0, 0, 0}, {0, 0, 0, 0}, {0, 1, 1, 0}, {0, 0, 1, 1}},
+        {{0, 0, 0, 0}, {0, 0, 1, 0}, {0, 1, 1, 0}, {0, 1, 0, 0}},
+        {{0, 0, 0, 0}, {0, 0, 0, 0}, {0, 1, 1, 0}, {0, 0, 1, 1}},
+        {{0, 0, 0, 0}, {0, 0, 1, 0}, {0, 1, 1, 0}, {0, 1, 0, 0}}
+    }
+};
+
+/*
+ Boundary of block.
+ Block is in the field if x coordination is in x1 ~ x2 and y coordination is in y1 ~ y2.
+ size_x and size_y are the width and height of block.
+ */
+typedef struct _Boundary{
+    int x1, x2, y1, y2;
+    int size_x, size_y;
+}Boundary;
+
+/*
+ Profile of columns of block.
+ top and bottom are the highest and lowest rows of block in each column of block. (-1 if column is empty)
+ Cells of block in each column are contiguous, so these are enough to find where block lands.
+ */
+typedef struct _Profile{
+    int top[BLOCK_WIDTH], bottom[BLOCK_WIDTH];
+}Profile;
+
+/*
+ Tables of blocks on the board of W x H which are derived from block at compile time, so they can't be different from block.
+ mask: Rows of each block as bit masks which are shifted to x coordination. ([blockId][blockRotate][blockX + MASK_OFFSET][row])
+       Bits of columns which get out of the field are dropped. Such x coordinations are out of the boundary of block.
+ */
+template<int W, int H> struct BlockTable {
+    Boundary boundary[NUM_OF_SHAPE][NUM_OF_ROTATE];
+    Profile profile[NUM_OF_SHAPE][NUM_OF_ROTATE];
+    unsigned short mask[NUM_OF_SHAPE][NUM_OF_ROTATE][W + MASK_OFFSET][BLOCK_HEIGHT];
+};
+
+template<int W, int H> constexpr BlockTable<W, H> makeBlockTable() {
+    BlockTable<W, H> t = {};
+    int id = 0, r = 0, x = 0, i = 0, j = 0, left = 0, right = 0, top = 0, bottom = 0;
+    for(id = 0; id < NUM_OF_SHAPE; id++) {
+        for(r = 0; r < NUM_OF_ROTATE; r++) {
+            left = top = BLOCK_WIDTH;
+            right = bottom = -1;
+            for(j = 0; j < BLOCK_WIDTH; j++) t.profile[id][r].top[j] = t.profile[id][r].bottom[j] = -1;
+            for(i = 0; i < BLOCK_HEIGHT; i++) {
+                for(j = 0; j < BLOCK_WIDTH; j++) {
+                    if(block[id][r][i][j] == 0) continue;
+                    if(t.profile[id][r].top[j] < 0) t.profile[id][r].top[j] = i;
+                    t.profile[id][r].bottom[j] = i;
+                    if(j < left) left = j;
+                    if(j > right) right = j;
+                    if(i < top) top = i;
+                    if(i > bottom) bottom = i;
+                }
+            }
+            t.boundary[id][r] = {-left, W - 1 - right, -top, H - 1 - bottom, right - left + 1, bottom - top + 1};
+            for(x = -MASK_OFFSET; x < W; x++)
+                for(i = 0; i < BLOCK_HEIGHT; i++)
+                    for(j = 0; j < BLOCK_WIDTH; j++)
+                        if(block[id][r][i][j] == 1 && x + j >= 0 && x + j < W)
+                            t.mask[id][r][x + MASK_OFFSET][i] |= 1 << (x + j);
+        }
+    }
+    return t;
+}
+
+template<int W, int H> constexpr BlockTable<W, H> blockTable = makeBlockTable<W, H>();
+// Tables of the default board.
+static constexpr const Boundary (&boundary)[NUM_OF_SHAPE][NUM_OF_ROTATE] = blockTable<WIDTH, HEIGHT>.boundary;
+static constexpr const Profile (&blockProfile)[NUM_OF_SHAPE][NUM_OF_ROTATE] = blockTable<WIDTH, HEIGHT>.profile;
+static constexpr const unsigned short (&blockMask)[NUM_OF_SHAPE][NUM_OF_ROTATE][WIDTH + MASK_OFFSET][BLOCK_HEIGHT] = blockTable<WIDTH, HEIGHT>.mask;
+
+const int rotateNum[NUM_OF_SHAPE] = {2, 4, 4, 4, 1, 2, 2};
+
+/*
+ Structure of field of game on the board of W x H.
+ Each line of field is stored as bit mask. (Bit j of line[i] is set if the cell of i-th row and j-th column is filled.)
+ Heights and holes of each column and the sums of them are updated whenever block is added or lines are deleted,
+ so the properties of field can be obtained without scanning the whole field.
+ Colors of blocks are not stored here. They are stored in the separate array only for printing the field.
+ */
+template<int W, int H> struct Field {
+    static_assert(W >= BLOCK_WIDTH && W <= MAX_WIDTH && H >= BLOCK_HEIGHT && H <= MAX_HEIGHT, "Board doesn't fit in lines of field.");
+    unsigned short line[H];
+    char height[W];                             // Height of each column.
+    char holes[W];                              // # of holes of each column.
+    int sumOfHeight;                            // Sum of heights of each column.
+    int sumOfSquareOfHeight;                    // Sum of squares of heights of each column.
+    int countOfHoles;                           // # of holes of field.
+    int countOfBlockades;                       // # of blocks of the columns which have holes.
+    int maxHeight;                              // Maximum of heights of each column.
+};
+typedef Field<WIDTH, HEIGHT> FIELD;
+
+/*
+ State of pseudo random number generator. (xoshiro256**)
+ Each game has its own generator, so games can be played on any thread and reproduced from the seed.
+ */
+typedef struct _RANDOM {
+    uint64_t s[4];
+} RANDOM;
+
+/*
+ Derives the seed of independent generator from seed and value. (splitmix64)
+ Functions of generator are constexpr, so tables of random keys can be made at compile time.
+ */
+constexpr uint64_t splitSeed(uint64_t seed, uint64_t value) {
+    uint64_t z = seed + (value + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/*
+ Initializes the state of generator from seed.
+ */
+constexpr void initRandom(RANDOM *rng, uint64_t seed) {
+    int i = 0;
+    for(i = 0; i < 4; i++) rng->s[i] = seed = splitSeed(seed, i);
+}
+
+/*
+ Returns next 64-bit random number of generator.
+ */
+constexpr uint64_t nextRandom(RANDOM *rng) {
+    uint64_t *s = rng->s;
+    uint64_t result = s[1] * 5, t = s[1] << 17;
+    result = ((result << 7) | (result >> 57)) * 9;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = (s[3] << 45) | (s[3] >> 19);
+    return result;
+}
+
+/*
+ Structure of play of block.
+ */
+typedef struct _CANDIDATE {
+    int blockX, blockY, blockRotate;            // Rotation status and position of block.
+    double score;                               // Score of field after the play.
+} CANDIDATE;
+
+/*
+ Features of fields after plays of a block on the board of W x H.
+ They are stored as structure of arrays, so scores of all plays can be calculated at once by SIMD instructions.
+ */
+template<int W, int H> struct Feature {
+    alignas(32) int touched[MAX_CANDIDATE_OF(W)];               // Gotten score by reaching block to the floor.
+    alignas(32) int removed[MAX_CANDIDATE_OF(W)];               // Gotten score by removing lines.
+    alignas(32) int sumOfHeight[MAX_CANDIDATE_OF(W)];           // Sum of heights of each column of field.
+    alignas(32) int sumOfSquareOfHeight[MAX_CANDIDATE_OF(W)];   // Sum of squares of heights of each column of field.
+    alignas(32) int countOfHoles[MAX_CANDIDATE_OF(W)];          // # of holes.
+    alignas(32) int countOfBlockades[MAX_CANDIDATE_OF(W)];      // # of blockades.
+    alignas(32) int countOfWallSides[MAX_CANDIDATE_OF(W)];      // # of blocks reached at wall.
+    alignas(32) int heightDifference[MAX_CANDIDATE_OF(W)];      // Difference between max height and min height of edges.
+    alignas(32) double score[MAX_CANDIDATE_OF(W)];              // Score of each play.
+};
+typedef Feature<WIDTH, HEIGHT> FEATURE;
+
+/*
+ Structure of node for state space tree on the board of W x H.
+ Each node stores the state of game.
+ Nodes are not allocated during the search. Each game has a stack of nodes, and the child node of node[i] is node[i + 1].
+ Level of node is the index of it in the stack, and it is a template argument of searchPlay().
+ */
+template<int W, int H> struct Node {
+    Field<W, H> recField;                       // State of field.
+    CANDIDATE candidate[MAX_CANDIDATE_OF(W)];   // Plays of the block of this level.
+    Feature<W, H> feature;                      // Features of fields after the plays.
+    int countOfCandidate;                       // # of plays of the block of this level.
+    int blockX, blockY, blockRotate;            // Rotation status and position of block which shows the best performance.
+};
+typedef Node<WIDTH, HEIGHT> NODE;
+
+/*
+ Entry of transposition table.
+ It stores the best accumulated score of the subtree of node whose field and level give the key.
+ */
+typedef struct _TRANSPOSITION {
+    uint64_t key;                               // Zobrist hash of field and level.
+    double score;                               // Best accumulated score of subtree.
+    unsigned int stamp;                         // Search which stored this entry. Entries of previous searches are ignored.
+} TRANSPOSITION;
+
+/*
+ Structure of state of search.
+ Each game has its own state, so games can be played on any thread.
+ */
+typedef struct _SEARCH {
+    const double *weight;                       // Weights of factors of individual.
+    bool simd;                                  // Score plays by AVX2 instructions. (Only if checkSIMD() returns true)
+    RANDOM *rng;                                // Generator for choosing one of plays with the same score.
+    int depth;                                  // # of blocks to look ahead.
+    int beamWidth;                              // # of best plays of each level to look ahead. (0: all plays)
+    TRANSPOSITION *table;                       // Transposition table. (SIZE_OF_TRANSPOSITION entries)
+    unsigned int stamp;                         // Current search. Increased whenever recommended play is obtained.
+    long long countOfNode;                      // # of expanded nodes. (Nodes found in transposition table are not counted.)
+} SEARCH;
+
+/*
+ Options of game.
+ */
+typedef struct _GAME_OPTION {
+    int width, height;                          // Size of board. (One of FOR_EACH_BOARD)
+    int depth;                                  // # of blocks to look ahead.
+    int beamWidth;                              // # of best plays of each level to look ahead. (0: all plays)
+    int limitOfPiece;                           // Maximum # of blocks of game. (0: unlimited)
+} GAME_OPTION;
+
+/*
+ Sequence of blocks which is shared by games. It is used to play games of different individuals with the same blocks.
+ Blocks are packed in words by 3 bits and generated lazily by chunks when a game reaches the end of generated blocks.
+ Games on any thread can read it. Generation is done in the lock, and countOfPiece is published after the blocks are written.
+ Chunks are kept when the sequence is reset, so they are allocated only when the sequence gets longer than ever.
+ After MAX_CHUNK chunks, the sequence is repeated from the beginning.
+ */
+typedef struct _PIECE_SEQUENCE {
+    uint64_t *chunk[MAX_CHUNK];                 // Chunks of packed blocks. (NULL: not allocated)
+    std::atomic<long long> countOfPiece;        // # of generated blocks.
+    RANDOM rng;                                 // Generator of blocks. Only used in the lock.
+    omp_lock_t lock;
+} PIECE_SEQUENCE;
+
+/*
+ Statistics of game.
+ */
+typedef struct _GAME_STAT {
+    int countOfPiece;                           // # of stacked blocks.
+    long long countOfNode;                      // # of nodes expanded by the search.
+} GAME_STAT;
+
+/*
+ Display of game.
+ draw() is called with the colors of blocks of field whenever block is stacked. (arg: argument of draw())
+ Only the first rows and columns of color which are in the board of game are used.
+ */
+typedef struct _DISPLAY {
+    void (*draw)(void *arg, const char color[MAX_HEIGHT][MAX_WIDTH], int score);
+    void *arg;
+} DISPLAY;
+
+#ifdef COUNT_ALLOCATION
+extern long long allocationOfGame;
+#endif
+
+void initTetris(bool simd);
+bool checkBoard(int width, int height);
+int playTetris(const double *weight, const GAME_OPTION *option, PIECE_SEQUENCE *sequence, RANDOM *rng, DISPLAY *display, GAME_STAT *stat);
+template<int W, int H> int playTetrisOnBoard(const double *weight, const GAME_OPTION *option, PIECE_SEQUENCE *sequence, RANDOM *rng, DISPLAY *display, GAME_STAT *stat);
+void initPieceSequence(PIECE_SEQUENCE *sequence);
+void resetPieceSequence(PIECE_SEQUENCE *sequence, uint64_t seed);
+void freePieceSequence(PIECE_SEQUENCE *sequence);
+int getPiece(PIECE_SEQUENCE *sequence, long long index);
+int randomInt(RANDOM *rng, int n);
+double randomDouble(RANDOM *rng);
+template<int W, int H> uint64_t hashField(const Field<W, H> *f, int level);
+bool checkSIMD(bool simd);
+template<int W, int H> double scoreFeature(Feature<W, H> *f, int count, const double *weight, bool simd);
+template<int W, int H> double scoreFeatureScalar(Feature<W, H> *f, int count, const double *weight);
+template<int W, int H> void initField(Field<W, H> *f);
+template<int W, int H> void initFieldFromLines(Field<W, H> *f, const unsigned short line[H]);
+template<int W, int H> void updateColumnOfField(Field<W, H> *f, int column, int height, int holes);
+template<int W, int H> bool checkBlockCanMove(const Field<W, H> *f, int blockId, int blockRotate, int blockY, int blockX);
+template<int W, int H> int getLandingY(const Field<W, H> *f, int blockId, int blockRotate, int blockX);
+template<int W, int H> int addBlockToField(Field<W, H> *f, int blockId, int blockRotate, int blockY, int blockX);
+template<int W, int H> int deleteLineFromField(Field<W, H> *f);
+void addBlockToColor(char c[MAX_HEIGHT][MAX_WIDTH], int blockId, int blockRotate, int blockY, int blockX);
+template<int W, int H> void deleteLineFromColor(char c[MAX_HEIGHT][MAX_WIDTH], const Field<W, H> *f);
+template<int W, int H> void getRecommendedPlay(Node<W, H> *root, int *blockRotate, int *blockY, int *blockX, int blockQueue[], SEARCH *search);
+template<int W, int H, int D, int L> double searchPlay(Node<W, H> *parent, int blockQueue[], SEARCH *search);
+
+#endif
@@ -0,0 +1,80 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+#include "genetic.h"
+#include "remote.h"
+
+using namespace std;
+
+/*
+ Prints the result of generation g of k-th island and writes it to the files. (arg: options of learning)
+ In steady state, checkpoint is also written here, because generations are finished while the other islands are played.
+ */
+void finishGeneration(void *arg, int k, const GENERATION *g) {
+    const CONFIG *config = (const CONFIG*)arg;
+    long long countOfNode = 0;
+    for(const INDIVIDUAL_STAT &stat : g->telemetry.individual) countOfNode += stat.countOfNode;
+    if(config->countOfIsland > 1) printf("Island %d ", k + 1);
+    printf("Gen %d : max score %.2lf, average score %.2lf, average piece %.1lf, time %.2lfs, nodes/s %.0lf, utilization %.1lf%%\n",
+           g->gen, g->best.score, g->averageScore, g->averagePiece, g->telemetry.wallTime, countOfNode / g->telemetry.wallTime, getUtilization(&g->telemetry) * 100);
+#ifdef COUNT_ALLOCATION
+    printf("Heap allocations %lld\n", allocationOfGame);
+    allocationOfGame = 0;
+#endif
+    fflush(stdout);
+    writeBestIndividual("output.txt", k, g);
+    if(config->logFile != NULL) writeTelemetry(config->logFile, k, g);
+    if(config->steadyState && k == 0 && !saveCheckpoint(config, g->gen)) fprintf(stderr, "Cannot write checkpoint: %s\n", config->checkpointFile);
+}
+
+/*
+ Headless trainer. It runs the same genetic algorithm as the ncurses demo without drawing anything,
+ and prints one line of log per generation to the standard output.
+ With '-listen', games are played by workers, which are also this program with '-worker'.
+ */
+int main(int argc, char *argv[]) {
+    int i, previousGen;
+    CONFIG config;
+    MONITOR monitor;
+    const char *coordinatorAddress = NULL;
+    
+    initConfig(&config);
+    for(i = 1; i < argc; i++) {
+        if(parseConfig(&config, argc, argv, &i)) continue;
+        else if(strcmp(argv[i], "-worker") == 0 && i < argc - 1) coordinatorAddress = argv[++i];
+        else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    
+    initTetris(config.simd);
+    if(coordinatorAddress != NULL) return runWorker(coordinatorAddress, config.threadCount);
+    if(!initTraining(&config)) {
+        fprintf(stderr, "Cannot resume from checkpoint: %s\n", config.resumeFile);
+        return 1;
+    }
+    if(config.listenPort > 0 && !startCoordinator(config.listenPort)) {
+        fprintf(stderr, "Cannot listen on port %d\n", config.listenPort);
+        return 1;
+    }
+    
+    printf("Seed: %llu, Threads: %d, Depth: %d, Beam: %d, Population: %d, Islands: %d, Generation: %d%s\n", (unsigned long long)config.seed, config.threadCount,
+           config.depth, config.beamWidth, config.countOfPopulation, config.countOfIsland, islands[0].gen, config.steadyState ? ", Steady state" : "");
+    fflush(stdout);
+    monitor.gameFinished = NULL;
+    monitor.generationFinished = finishGeneration;
+    monitor.display = NULL;
+    monitor.countOfDisplay = 0;
+    monitor.arg = &config;
+    for(;;)
+    {
+        previousGen = islands[0].gen;
+        if(runGenerations(&config, &monitor) == 0) break;
+        if(!config.steadyState && !saveCheckpoint(&config, previousGen)) fprintf(stderr, "Cannot write checkpoint: %s\n", config.checkpointFile);
+    }
+    stopCoordinator();
+    freeIslands();
+    return 0;
+}